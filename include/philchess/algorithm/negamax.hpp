@@ -32,14 +32,20 @@ auto negamax(BOARD_T& board, SEARCH_CONTROL_T& control, DECISION_FUN_T decision_
 	using score_t=typename SEARCH_CONTROL_T::score_value_type;
 	auto cached_return=[&control, &board, depth=leftover_depth](score_t score, score_type type, move m) { control.cache_eval(board,score,type,m,depth); return score; };
 	
-	const auto abort_result=control.should_abort_branch(board, leftover_depth, desired_depth);
+	const auto abort_result=control.should_abort_branch(board, decision_fun, leftover_depth, desired_depth);
 	if(abort_result)
 		return *abort_result;
 		
 	move best_move;
 	
+	auto cached_eval=control.cached_eval(board,leftover_depth);
+	//Exact scores and lower bounds put their move straight into the pv(and possibly make it the bestmove), so on a false hit it had better still be one that can be played here.
+	//Upper bounds carry no move worth anything and the picker checks the hash move itself, so this is the one place to bother.
+	if(cached_eval && cached_eval->type!=score_type::upper_bound && !board.is_legal(cached_eval->m))
+		cached_eval.reset();
+	
 	const auto cached_result=handle_cached_eval(
-		control.cached_eval(board,leftover_depth),control,decision_fun,
+		cached_eval,control,decision_fun,
 		[&](const auto& eval){ best_move=eval->m; control.handle_new_best_move(board,eval->m,desired_depth-leftover_depth); },
 		desired_depth-leftover_depth
 	);
@@ -59,15 +65,15 @@ auto negamax(BOARD_T& board, SEARCH_CONTROL_T& control, DECISION_FUN_T decision_
 		return *pruning_score;
 		
 	auto movelist=control.list_moves(board,decision_fun, desired_depth,leftover_depth);
-	if(movelist.empty())
-		return control.mate_eval(board, desired_depth-leftover_depth);
-	
 	control.adjust_depth(desired_depth, leftover_depth, board, movelist);
 		
 	score_type type=score_type::upper_bound;
+	bool have_moves=false; //the movelist may well be generated lazily, so this is only known after trying
 	
 	for(const auto move: movelist)
 	{
+		have_moves=true;
+		
 		score_t score;
 		auto potential_score=control.scout(move,board,decision_fun, abort_fun, leftover_depth, desired_depth);
 		if(potential_score)
@@ -101,6 +107,9 @@ auto negamax(BOARD_T& board, SEARCH_CONTROL_T& control, DECISION_FUN_T decision_
 		}
 	}
 	
+	if(!have_moves)
+		return control.mate_eval(board, desired_depth-leftover_depth);
+	
 	return cached_return(decision_fun.get_score(),type, best_move);
 }
 
@@ -6,16 +6,62 @@
 
 #include <array>
 
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__BMI2__) && !defined(PHILCHESS_USE_MAGIC_BITBOARDS)
+#include <immintrin.h>
+#endif
+
 namespace philchess
 {
 	namespace detail
 	{
-		square_table<bitboard::rank> compute_knight_attacks() noexcept;
-		square_table<bitboard::rank> compute_king_attacks() noexcept;
-		square_table<std::array<bitboard::rank,256>> compute_rook_rank_attacks() noexcept;
-		square_table<std::array<bitboard::rank,256>> compute_rook_file_attacks() noexcept;
-		square_table<std::array<bitboard::rank,256>> compute_bishop_diagonal_attacks() noexcept;
-		square_table<std::array<bitboard::rank,256>> compute_bishop_antidiagonal_attacks() noexcept;
+		//All tables are generated at compile time(see src/bitboard_patterns.cpp) and live in read-only data, no initialization at runtime whatsoever.
+		extern const square_table<bitboard::rank> knight_attacks;
+		extern const square_table<bitboard::rank> king_attacks;
+		
+		/*
+			Sliding attacks are looked up by the occupancy of the squares relevant to the given square(the rays without their last square,
+			it does not matter whether that is occupied...). Those bits are mapped to a dense index either by multiplying with a magic number
+			and keeping the upper bits, or by simply gathering them with pext, if the cpu has it. pext is the default with BMI2, but some(older AMD) cpus
+			implement it in microcode and are much faster with magics, so define PHILCHESS_USE_MAGIC_BITBOARDS there.
+		*/
+		struct slider_entry
+		{
+			std::uint64_t mask;
+			std::uint64_t magic; //unused with pext
+			unsigned shift;
+			const bitboard::rank* attacks;
+		};
+		
+		extern const square_table<slider_entry> rook_attacks;
+		extern const square_table<slider_entry> bishop_attacks;
+		
+		struct line_masks
+		{
+			square_table<bitboard::rank> files, ranks, diagonals, antidiagonals; //the diagonal is the one with constant rank+file, the antidiagonal the one with constant rank-file
+		};
+		
+		extern const line_masks lines;
+		
+		//the squares strictly between two squares sharing a rank, file or diagonal, none at all for any other pair
+		extern const square_table<square_table<bitboard::rank>> between;
+		
+		inline bitboard::rank lookup_slider_attacks(const square_table<slider_entry>& table, square sq, const bitboard::rank& occupancy) noexcept
+		{
+			const auto& entry=table[sq];
+#if defined(__BMI2__) && !defined(PHILCHESS_USE_MAGIC_BITBOARDS)
+			return entry.attacks[_pext_u64(occupancy.ranks(),entry.mask)];
+#else
+			return entry.attacks[((occupancy.ranks()&entry.mask)*entry.magic)>>entry.shift];
+#endif
+		}
+	}
+	
+	inline bitboard::rank squares_between(square a, square b) noexcept
+	{
+		return detail::between[a][b];
 	}
 	
 	inline bitboard::rank attacked_by_pawn(side s, square sq) noexcept
@@ -27,63 +73,50 @@ namespace philchess
 	
 	inline bitboard::rank attacked_by_knight(square sq) noexcept
 	{
-		static const auto& map=detail::compute_knight_attacks();
-		return map[sq];
+		return detail::knight_attacks[sq];
 	}
 	
-	inline bitboard::rank attacked_by_bishop_on_diagonal(square sq, const bitboard::all& occupancy) noexcept
+	inline bitboard::rank attacked_by_bishop(square sq, const bitboard::rank& occupancy) noexcept
 	{
-		static const auto& antidiagonal_map=detail::compute_bishop_antidiagonal_attacks();
-		return antidiagonal_map[sq][occupancy.file_indexed_unmasked_diagonal(sq.diagonal())];
+		return detail::lookup_slider_attacks(detail::bishop_attacks,sq,occupancy);
 	}
 	
-	inline bitboard::rank attacked_by_bishop_on_antidiagonal(square sq, const bitboard::all& occupancy) noexcept
+	inline bitboard::rank attacked_by_rook(square sq, const bitboard::rank& occupancy) noexcept
 	{
-		static const auto& diagonal_map=detail::compute_bishop_diagonal_attacks(); //what? why?
-		return diagonal_map[sq][occupancy.file_indexed_unmasked_anti_diagonal(sq.antidiagonal())];
+		return detail::lookup_slider_attacks(detail::rook_attacks,sq,occupancy);
 	}
 	
-	inline bitboard::rank attacked_by_bishop(square sq, const bitboard::all& occupancy) noexcept
+	inline bitboard::rank attacked_by_bishop_on_diagonal(square sq, const bitboard::rank& occupancy) noexcept
 	{
-		static const auto& diagonal_map=detail::compute_bishop_diagonal_attacks();
-		static const auto& antidiagonal_map=detail::compute_bishop_antidiagonal_attacks();
-		return diagonal_map[sq][occupancy.file_indexed_unmasked_anti_diagonal(sq.antidiagonal())] | antidiagonal_map[sq][occupancy.file_indexed_unmasked_diagonal(sq.diagonal())];
+		return attacked_by_bishop(sq,occupancy)&detail::lines.diagonals[sq];
 	}
 	
-	inline bitboard::rank attacked_by_rook_on_file(square sq, const bitboard::all& occupancy) noexcept
+	inline bitboard::rank attacked_by_bishop_on_antidiagonal(square sq, const bitboard::rank& occupancy) noexcept
 	{
-		static const auto& rank_map=detail::compute_rook_rank_attacks();
-
-		return rank_map[sq][occupancy.file(sq.file())];
+		return attacked_by_bishop(sq,occupancy)&detail::lines.antidiagonals[sq];
 	}
 	
-	inline bitboard::rank attacked_by_rook_on_rank(square sq, const bitboard::all& occupancy) noexcept
+	inline bitboard::rank attacked_by_rook_on_file(square sq, const bitboard::rank& occupancy) noexcept
 	{
-		static const auto& file_map=detail::compute_rook_file_attacks();
-
-		return file_map[sq][occupancy.rank(sq.rank())];
+		return attacked_by_rook(sq,occupancy)&detail::lines.files[sq];
 	}
 	
-	inline bitboard::rank attacked_by_rook(square sq, const bitboard::all& occupancy) noexcept
+	inline bitboard::rank attacked_by_rook_on_rank(square sq, const bitboard::rank& occupancy) noexcept
 	{
-		static const auto& rank_map=detail::compute_rook_rank_attacks();
-		static const auto& file_map=detail::compute_rook_file_attacks();
-
-		return rank_map[sq][occupancy.file(sq.file())]|file_map[sq][occupancy.rank(sq.rank())];
+		return attacked_by_rook(sq,occupancy)&detail::lines.ranks[sq];
 	}
 	
-	inline bitboard::rank attacked_by_queen(square sq, const bitboard::all& occupancy) noexcept
+	inline bitboard::rank attacked_by_queen(square sq, const bitboard::rank& occupancy) noexcept
 	{
 		return attacked_by_rook(sq,occupancy) | attacked_by_bishop(sq,occupancy);
 	}
 	
 	inline bitboard::rank attacked_by_king(square sq) noexcept
 	{
-		static const auto& map=detail::compute_king_attacks();
-		return map[sq];
+		return detail::king_attacks[sq];
 	}
 	
-	inline bitboard::rank attacked_by(side s, piece_type type, square sq, const bitboard::all& occupancy) noexcept
+	inline bitboard::rank attacked_by(side s, piece_type type, square sq, const bitboard::rank& occupancy) noexcept
 	{
 		switch(type)
 		{
@@ -99,7 +132,7 @@ namespace philchess
 	}
 	
 	template <piece_type type>
-	bitboard::rank attacked_by(side s, square sq, const bitboard::all& occupancy) noexcept
+	bitboard::rank attacked_by(side s, square sq, const bitboard::rank& occupancy) noexcept
 	{
 		if constexpr (type==piece_type::pawn)
 			return attacked_by_pawn(s,sq);
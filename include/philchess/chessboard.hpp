@@ -2,67 +2,135 @@
 #define PHILCHESS_CHESSBOARD_H
 
 #include <philchess/bitboard.hpp>
+#include <philchess/material_signature.hpp>
 #include <philchess/types.hpp>
 #include <philchess/zobrist.hpp>
 
 #include <philchess/algorithm/alpha_beta_pruning.hpp>
 #include <philchess/algorithm/negamax.hpp>
 
+#include <philchess/eval/nnue.hpp>
 #include <philchess/eval/piece_square_table.hpp>
 
 #include <ptl/fixed_capacity_vector.hpp>
 
 #include <algorithm>
 #include <array>
+#include <string>
 #include <string_view>
 #include <vector>
 
+#include <cstddef>
 #include <cstdint>
 
 namespace philchess
 {
 	//needed for the friend declaration below...
 	class chessboard;
+	struct position_record;
 	namespace eval
 	{
-		template <typename EVAL_T, typename PARAMETERS_T>
-		EVAL_T default_evaluation(const chessboard& board, const PARAMETERS_T& parameters) noexcept;
+		template <typename EVAL_T, typename PARAMETERS_T, typename PAWN_CACHE_T>
+		EVAL_T default_evaluation(const chessboard& board, const PARAMETERS_T& parameters, PAWN_CACHE_T& pawn_cache) noexcept;
 		
 		template <bool want_value>
 		auto see(const chessboard& board, move m, std::bool_constant<want_value> tag) noexcept;
 	}
 	
-	class chessboard
+	/*
+		Everything that makes up a position, without the history of how we got there. Kept in one piece, so that it can simply be copied,
+		which is what do_move/undo_move do instead of making and unmaking moves when PHILCHESS_COPY_MAKE is defined.
+		Only the chessboard itself is supposed to touch any of this.
+	*/
+	struct position_state
 	{
-		public:
-		chessboard() noexcept
-		{
-			played_moves_.reserve(256);
-			hashes_.reserve(256);
-		}
-		
 		struct check_info_t
 		{
 			bool in_check() const noexcept { return !checkers.empty(); }
 			ptl::fixed_capacity_vector<philchess::square,2> checkers;
 		};
 		
+		/*
+			Computed once per position, so that would_check and the legality checks are down to a few ands:
+			The squares from which each piece type of the side to move would attack the opponent king, and for both kings,
+			the pieces(of either side) that are all that stands between them and an enemy slider, along with the sliders pinning own pieces that way.
+		*/
+		struct pin_info_t
+		{
+			piece_type_map<bitboard::rank> check_squares;
+			side_map<bitboard::rank> blockers, pinners;
+		};
+		
+		square_table<piece_type> data_;
+		side to_move_=side::white;
+		
+		side_map<castling_right> castling_rights_{{{ castling_right::both, castling_right::both }}};
+		std::uint8_t enpassant_file_=8; //invalid, somehow should make this more clear and get rid of the stupid number
+		std::uint8_t fifty_move_counter_=0;
+		
+		zobrist zobrist_hash_;
+		zobrist pawn_hash_; //only the pawns, maintained alongside the full one
+		material_signature material_;
+		side_map<int> middlegame_pst_{}, endgame_pst_{};
+				
+		bitboard::rank occupancy_;
+		side_map<bitboard::rank> side_occupancy_;
+		
+		piece_type_map<bitboard::rank> piece_bitboards_;
+		
+		side_map<square> king_squares_;
+		
+		check_info_t check_inf_;
+		pin_info_t pin_inf_;
+	};
+	
+	class chessboard: private position_state
+	{
+		public:
+		chessboard() noexcept=default;
+		
+		using check_info_t=position_state::check_info_t;
+		using pin_info_t=position_state::pin_info_t;
+		
 		void setup(std::string_view fen_string);
+		void setup(const position_record& record) noexcept; //the same, without any parsing. just as trusting, so check record.is_valid() first if it could be garbage
 		
-		struct undoable_move { philchess::move move; piece_type old; side_map<castling_right> castling; std::uint8_t old_enpassant; std::uint8_t old_movecount; check_info_t check_inf; };
+		//the move number is not kept track of, so that is always 1
+		std::string fen() const;
+		
+#if defined(PHILCHESS_COPY_MAKE)
+		struct undoable_move { philchess::move move; }; //the position before is in the history
+#else
+		struct undoable_move { philchess::move move; side_map<castling_right> castling; std::uint8_t old_enpassant; check_info_t check_inf; }; //the captured piece and fifty move counter are in the history
+#endif
 		
 		undoable_move do_move(philchess::move m) noexcept;
 		void undo_move(undoable_move m) noexcept;
 		
-		struct nullmove_data{ std::uint8_t old_enpassant; std::uint8_t old_movecount; check_info_t check_inf; }; 
+		struct nullmove_data{ std::uint8_t old_enpassant; check_info_t check_inf; pin_info_t pin_inf; }; 
 		
 		nullmove_data do_nullmove() noexcept;
 		void undo_nullmove(nullmove_data data) noexcept;
 		
-		bool last_move_was_null() const noexcept { return !played_moves_.empty() && played_moves_.back().to()==played_moves_.back().from(); }
+		bool last_move_was_null() const noexcept { return plies_!=0 && last_ply().move.to()==last_ply().move.from(); }
 		
 		ptl::fixed_capacity_vector<philchess::move,220> list_moves() const noexcept; //(220 seems to be an agreed upon upper bound on number of moves in any given position...)
 		ptl::fixed_capacity_vector<philchess::move,220> list_noisy_moves() const noexcept;
+		ptl::fixed_capacity_vector<philchess::move,220> list_quiet_moves() const noexcept; //everything list_moves has, but list_noisy_moves has not
+		
+		/*
+			Same split, but without caring about pins or the king walking into an attack, which is most of the work of the legal ones.
+			Only for positions that are not in check, anything they return still has to pass leaves_king_safe before it is played.
+			Castling is the exception, that is always checked right away.
+		*/
+		ptl::fixed_capacity_vector<philchess::move,220> list_pseudo_legal_noisy_moves() const noexcept;
+		ptl::fixed_capacity_vector<philchess::move,220> list_pseudo_legal_quiet_moves() const noexcept;
+		
+		//for pseudo legal moves while not in check: whether the own king is still safe afterwards
+		bool leaves_king_safe(philchess::move m) const noexcept;
+		
+		//for moves that did not come from the move generator in this very position(transposition table, killers...), and as such might be complete garbage
+		bool is_legal(philchess::move m) const noexcept;
 		
 		side side_to_move() const noexcept { return to_move_; }
 		
@@ -70,7 +138,35 @@ namespace philchess
 		bool is_in_check() const noexcept;
 		bool is_rule_draw() const noexcept;
 		
+		//whether a single move by the side to move repeats a position of the last ply plies, i.e. of the current search, which is as good as a draw
+		bool has_game_cycle(unsigned ply) const noexcept;
+		
 		auto hash() const noexcept { return zobrist_hash_; }
+		auto pawn_hash() const noexcept { return pawn_hash_; }
+		auto material() const noexcept { return material_; }
+		
+		//sums of the default middlegame and endgame piece square table values of all pieces of one side, kings included
+		auto middlegame_pst(side s) const noexcept { return middlegame_pst_[s]; }
+		auto endgame_pst(side s) const noexcept { return endgame_pst_[s]; }
+		
+		//recomputes everything maintained incrementally(hashes, material, piece square sums) from scratch and compares. slow, for testing only
+		bool incremental_state_is_consistent() const noexcept;
+		
+		/*
+			With a network set, do_move keeps its accumulators up to date for every position of the current line, so that evaluating it is only the small layers.
+			undo_move has nothing to do, the one from before is still there. Costs a bit per move, so only set it when the network is actually used, nullptr to stop.
+		*/
+		void set_network(const eval::nnue::network* net);
+		const eval::nnue::network* network() const noexcept { return network_; }
+		const eval::nnue::accumulator& accumulator() const noexcept { return accumulators_[plies_%history_size]; }
+		
+		//Called from within do_move as soon as the new hash is known, so that whoever is going to look it up next(the transposition table...) can already start fetching it while the rest of the move is done.
+		using prefetch_fun_t=void(*)(const void* context, zobrist hash) noexcept;
+		void set_prefetch_hook(prefetch_fun_t fun, const void* context) noexcept
+		{
+			prefetch_fun_=fun;
+			prefetch_context_=context;
+		}
 		
 		constexpr auto owner_at(square sq) const noexcept
 		{
@@ -89,34 +185,52 @@ namespace philchess
 			return castling_rights_;
 		}
 		
+		constexpr std::uint8_t enpassant_file() const noexcept { return enpassant_file_; } //8 if there is none
+		constexpr std::uint8_t fifty_move_counter() const noexcept { return fifty_move_counter_; }
+		
 		friend class default_search_control;
 			
-		template <typename EVAL_T, typename PARAMETERS_T>
-		friend EVAL_T philchess::eval::default_evaluation(const chessboard& board, const PARAMETERS_T& parameters) noexcept;
+		template <typename EVAL_T, typename PARAMETERS_T, typename PAWN_CACHE_T>
+		friend EVAL_T philchess::eval::default_evaluation(const chessboard& board, const PARAMETERS_T& parameters, PAWN_CACHE_T& pawn_cache) noexcept;
 		
 		template <bool want_value>
 		friend auto philchess::eval::see(const chessboard& board, move m, std::bool_constant<want_value> tag) noexcept;
 		
 		private:
-		square_table<piece_type> data_;
-		side to_move_=side::white;
-		
-		side_map<castling_right> castling_rights_{{{ castling_right::both, castling_right::both }}};
-		std::uint8_t enpassant_file_=8; //invalid, somehow should make this more clear and get rid of the stupid number
+		/*
+			What is left to remember of every move played, only for the last 256 of them, in a ring. Far more than the search ever undoes,
+			and repetitions cannot reach back further than the last capture or pawn move, which is never more than 100 plies ago without the game being drawn anyway.
+			No allocations, however long the game fed in over UCI, and the repetition scan walks through a few contiguous cache lines.
+		*/
+		struct ply_record
+		{
+			zobrist hash; //of the position before the move
+			philchess::move move;
+			std::uint8_t fifty_move_counter; //before the move, too
+			piece_type captured;
+#if defined(PHILCHESS_COPY_MAKE)
+			position_state state;
+#else
+			pin_info_t pin_inf; //before the move
+#endif
+		};
 		
-		zobrist zobrist_hash_;
-				
-		bitboard::all occupancy_;
-		side_map<bitboard::rank> side_occupancy_;
+		static constexpr std::size_t history_size=256;
+		std::array<ply_record,history_size> history_;
+		std::size_t plies_=0; //played since setup, the last one is at plies_-1 modulo history_size
 		
-		piece_type_map<bitboard::rank> piece_bitboards_;
+		ply_record& push_ply() noexcept { return history_[plies_++%history_size]; }
+		const ply_record& pop_ply() noexcept { return history_[--plies_%history_size]; }
+		const ply_record& last_ply() const noexcept { return history_[(plies_-1)%history_size]; }
 		
-		side_map<square> king_squares_;
+		prefetch_fun_t prefetch_fun_=nullptr;
+		const void* prefetch_context_=nullptr;
 		
-		std::vector<move> played_moves_;
-		std::vector<zobrist> hashes_;
+		const eval::nnue::network* network_=nullptr;
+		std::vector<eval::nnue::accumulator> accumulators_; //history_size of them, by ply like the history, only with a network
 		
-		std::uint8_t fifty_move_counter_=0;
+		void refresh_accumulator(side perspective) noexcept;
+		void update_accumulators(philchess::move m, piece_type moved_piece, piece_type captured) noexcept;
 		
 		friend struct board_proxy_t;
 		struct board_proxy_t
@@ -130,13 +244,15 @@ namespace philchess
 			constexpr auto castling_rights(side s) const noexcept { return board.castling_rights_[s]; }
 		};
 		
+		void compute_derived_state() noexcept; //everything but the pieces, side to move, castling rights, en passant and fifty move counter, at the end of setup
+		
 		void set_piece(square sq, piece_type p, side s) noexcept;
 		void unset_piece(square sq) noexcept;
 		
 		check_info_t check_info() const noexcept;
 		check_info_t compute_check_info() const noexcept;
 		check_info_t compute_initial_check_info() const noexcept;
-		check_info_t check_inf_;
+		pin_info_t compute_pin_info() const noexcept;
 		
 		template <typename T>
 		auto checked_evasion_move_adder(T& move_container, side opponent_side) const noexcept;
@@ -150,6 +266,9 @@ namespace philchess
 		auto generate_pinmap() const noexcept;
 		
 		zobrist calculate_zobrist_hash() const noexcept;
+		zobrist calculate_pawn_hash() const noexcept;
+		material_signature calculate_material_signature() const noexcept;
+		void calculate_pst_sums(side_map<int>& middlegame, side_map<int>& endgame) const noexcept;
 		
 		constexpr auto piece_bitboard(side s, piece_type type) const noexcept
 		{
@@ -2,12 +2,18 @@
 #define PHILCHESS_DEFAULT_SEARCH_CONTROL_H
 
 #include <philchess/chessboard.hpp>
+#include <philchess/move_picker.hpp>
+#include <philchess/transposition_table.hpp>
 #include <philchess/types.hpp>
 #include <philchess/zobrist.hpp>
 
 #include <philchess/algorithm/alpha_beta_pruning.hpp>
 #include <philchess/algorithm/negamax.hpp>
 
+#include <philchess/eval/eval_cache.hpp>
+#include <philchess/eval/evaluation_parameters.hpp>
+#include <philchess/eval/nnue.hpp>
+#include <philchess/eval/pawn_hash.hpp>
 #include <philchess/eval/see.hpp>
 
 #include <ptl/bit.hpp>
@@ -16,6 +22,7 @@
 #include <algorithm>
 #include <atomic>
 #include <array>
+#include <memory>
 #include <optional>
 #include <vector>
 
@@ -87,6 +94,8 @@ namespace philchess
 		{{
 			0,283,434,922,2203
 		}};
+		
+		bool upcoming_repetition_detection = true;
 	};
 	
 	class default_search_control
@@ -102,6 +111,11 @@ namespace philchess
 			parameters_=parameters;
 		}
 		
+		default_search_control(const search_parameters& parameters, std::shared_ptr<transposition_table> tt):
+			parameters_{parameters},
+			tt_{std::move(tt)}
+		{}
+		
 		struct eval_t { int eval; score_type type; move m; };
 		void cache_eval(const chessboard& board, int eval, score_type type, move m, std::uint8_t depth) noexcept;
 		std::optional<eval_t> cached_eval(const chessboard& board, std::uint8_t min_depth) const noexcept;
@@ -134,100 +148,30 @@ namespace philchess
 		template <typename DECISION_FUN_T>
 		auto list_moves(const chessboard& board, DECISION_FUN_T decision_fun, unsigned desired_depth, unsigned leftover_depth) const noexcept
 		{
-			auto depth=desired_depth-leftover_depth;
-			
-			auto moves=board.list_moves();
-			if(moves.size()>1)
-				order_moves(moves,board,depth);
-			
-			return moves;
-		}
-		
-		template <typename MOVELIST_T>
-		void order_moves(MOVELIST_T& movelist, const chessboard& board, unsigned depth) const noexcept
-		{
+			const auto depth=desired_depth-leftover_depth;
 			const auto cached=cached_eval(board, 0);
-		
-			auto sort_begin=std::begin(movelist);
-			if(cached)
-			{
-				const auto maybe_best=cached->m;
-				for(auto it=sort_begin;it!=std::end(movelist);++it)
-				{
-					auto& m=*it;
-					if(m==maybe_best)
-					{
-						std::swap(*sort_begin,m);
-						++sort_begin;
-						break;
-					}
-				}
-			}
 			
-			if(sort_begin!=std::end(movelist))
-			{
-				const auto capture_end=std::partition(sort_begin,std::end(movelist),[&](auto m)
-				{
-					return board.piece_type_at(m.to())!=piece_type::none && eval::see_gain(board,m);
-				});
-				
-				std::sort(sort_begin,capture_end,[&](auto lhs, auto rhs)
-				{		
-					const static auto& piece_square_tables=eval::get_default_piece_square_table();
-
-					const auto lhs_aggressor=piece_square_tables[board.to_move_][board.piece_type_at(lhs.from())][lhs.from()];
-					const auto rhs_aggressor=piece_square_tables[board.to_move_][board.piece_type_at(rhs.from())][rhs.from()];
-					
-					const auto lhs_victim=piece_square_tables[reverse(board.to_move_)][board.piece_type_at(lhs.to())][lhs.to()];
-					const auto rhs_victim=piece_square_tables[reverse(board.to_move_)][board.piece_type_at(rhs.to())][rhs.to()];
-											
-					return (lhs_victim>rhs_victim || (lhs_victim==rhs_victim && lhs_aggressor<rhs_aggressor));
-				});
-				
-				auto quiet_begin = capture_end;
-				for(auto it=quiet_begin;it!=std::end(movelist);++it)
-				{
-					auto& m=*it;
-					if(m==killers_[depth][0] || m==killers_[depth][1])
-					{
-						std::swap(*quiet_begin,m);
-						++quiet_begin;
-					}
-				}
-				
-				std::sort(quiet_begin,std::end(movelist),[&,this](auto lhs, auto rhs)
-				{
-					if(lhs.type()==move_type::promotion && rhs.type()!=move_type::promotion)
-						return true;
-					if(rhs.type()==move_type::promotion && lhs.type()!=move_type::promotion)
-						return false;
-					
-					if(history_counters_[board.piece_type_at(lhs.from())][lhs.to()]>history_counters_[board.piece_type_at(rhs.from())][rhs.to()])
-						return true;
-					if(history_counters_[board.piece_type_at(lhs.from())][lhs.to()]<history_counters_[board.piece_type_at(rhs.from())][rhs.to()])
-						return false;
-					return false;
-				});
-			}
+			return move_picker{board,cached?cached->m:move{},killers_[depth],history_counters_};
 		}
 		
 		template <typename MOVELIST_T>
 		void adjust_depth(unsigned& desired_depth, unsigned& leftover_depth,const chessboard& board, const MOVELIST_T& movelist) const noexcept
 		{
-			if(board.is_in_check() || movelist.size()==1)
+			if(board.is_in_check() || movelist.single_reply())
 			{
 				desired_depth+=1;
 				leftover_depth+=1;
 			}
 			
-			if(leftover_depth>1 && movelist.size()>1 && !cached_eval(board, 0)) //Internal iterative reductions!
+			if(leftover_depth>1 && !movelist.single_reply() && !cached_eval(board, 0)) //Internal iterative reductions!
 			{
 				desired_depth-=1;
 				leftover_depth-=1;
 			}
 		}
 		
-		std::optional<int> should_abort_branch(chessboard& board, unsigned leftover_depth, unsigned desired_depth) const noexcept
+		template <typename DECISION_FUN_T>
+		std::optional<int> should_abort_branch(chessboard& board, DECISION_FUN_T decision_fun, unsigned leftover_depth, unsigned desired_depth) const noexcept
 		{
 			++normal_nodes_;
 			
@@ -236,6 +180,16 @@ namespace philchess
 			if(board.is_rule_draw() || is_insufficient_material(board))
 				return 0;
 			
+			//if one move takes us back to where we have been in this line, we can have a draw whenever we like, so there is no need to look for anything worse
+			if
+			(
+				parameters_.upcoming_repetition_detection &&
+				-decision_fun.get_reversed().get_score()<=0 &&
+				board.has_game_cycle(desired_depth-leftover_depth) &&
+				decision_fun(0)==algorithm::search_decision::cutoff
+			)
+				return decision_fun.get_score();
+			
 			return std::nullopt;
 		}
 		
@@ -435,29 +389,39 @@ namespace philchess
 		unsigned number_of_traversed_nodes() const noexcept { return normal_nodes_; }
 		unsigned number_of_quiescent_nodes() const noexcept { return quiescent_nodes_; }
 		unsigned number_of_cache_hits() const noexcept { return cache_hits_; }
+		unsigned number_of_cache_probes() const noexcept { return cache_probes_; }
+		unsigned number_of_saved_evaluations() const noexcept { return saved_evaluations_; }
+		unsigned number_of_pawn_cache_hits() const noexcept { return pawn_cache_.number_of_hits(); }
+		unsigned number_of_pawn_cache_probes() const noexcept { return pawn_cache_.number_of_probes(); }
 		unsigned max_quiescent_depth() const noexcept { return quiescent_depth_; }
-		void reset_stats() noexcept { evaluated_node_num_=0; cache_hits_=0; quiescent_depth_=0; quiescent_nodes_=0; normal_nodes_=0; }
+		void reset_stats() noexcept { evaluated_node_num_=0; cache_hits_=0; cache_probes_=0; quiescent_depth_=0; quiescent_nodes_=0; normal_nodes_=0; saved_evaluations_=0; pawn_cache_.reset_stats(); }
 		
-		void reset_tt() noexcept
+		//evaluate with the network instead of the handcrafted evaluation, nullptr to go back. the boards searched need to have it set as well
+		void use_network(std::shared_ptr<const eval::nnue::network> net) noexcept
 		{
-			std::fill(std::begin(cache_),std::end(cache_),eval_data_t{});
+			network_=std::move(net);
+			eval_cache_.clear();
 		}
 		
-		void resize_tt(std::size_t max_size_in_mb)
+		//the weights of the handcrafted evaluation, the compiled in ones unless set otherwise
+		void set_evaluation_parameters(const eval::evaluation_parameters& parameters)
 		{
-			const auto max_number_of_entries = max_size_in_mb * 1024*1024 /sizeof(eval_data_t);
-			const auto power2_number_of_entries = ptl::bit_floor(max_number_of_entries);
-			
-			cache_.resize(power2_number_of_entries);
-			cache_hash_bitsize_ = ptl::bit_width(power2_number_of_entries) - 1;
+			eval_parameters_=parameters;
+			eval_cache_.clear();
+			pawn_cache_=eval::pawn_hash_table{};
 		}
+		const eval::evaluation_parameters& evaluation_parameters() const noexcept { return eval_parameters_; }
 		
-		std::size_t hashsize_bytes() const noexcept { return cache_.size()*sizeof(eval_data_t); }
+		void reset_tt() noexcept { tt_->reset(); }
+		unsigned hashfull() const noexcept { return tt_->hashfull(); }
+		void resize_tt(std::size_t max_size_in_mb) { tt_->resize(max_size_in_mb); }
+		std::size_t hashsize_bytes() const noexcept { return tt_->size_bytes(); }
+		std::size_t number_of_tt_entries() const noexcept { return tt_->number_of_entries(); }
 		
 		private:
 		search_parameters parameters_{};
 		
-		using history_counter_t=piece_type_map<square_table<unsigned>>;
+		using history_counter_t=move_picker::history_table;
 		
 		history_counter_t history_counters_{};
 					
@@ -470,12 +434,18 @@ namespace philchess
 		
 		static constexpr int max_mate_score=200000, min_mate_score=100000;
 		
-		struct eval_data_t{ philchess::zobrist zobrist_hash{}; int eval=0; move best_or_refutation_move; score_type type; std::uint8_t depth=0; };
-		std::vector<eval_data_t> cache_{2*1024*1024};
-		std::size_t cache_hash_bitsize_ = 21;
+		static std::int16_t to_tt_score(int score) noexcept;
+		static int from_tt_score(std::int16_t score) noexcept;
+		
+		std::shared_ptr<transposition_table> tt_=std::make_shared<transposition_table>();
+		
+		mutable std::atomic<unsigned> evaluated_node_num_{0}, cache_hits_{0}, cache_probes_{0}, quiescent_depth_{0}; 
+		mutable std::atomic<unsigned> quiescent_nodes_{0}, normal_nodes_{0}, saved_evaluations_{0};
 		
-		mutable std::atomic<unsigned> evaluated_node_num_{0}, cache_hits_{0}, quiescent_depth_{0}; 
-		mutable std::atomic<unsigned> quiescent_nodes_{0}, normal_nodes_{0};
+		mutable eval::pawn_hash_table pawn_cache_;
+		mutable eval::eval_cache<> eval_cache_;
+		std::shared_ptr<const eval::nnue::network> network_;
+		eval::evaluation_parameters eval_parameters_=eval::get_default_evaluation_parameters();
 				
 		std::array<ptl::fixed_capacity_vector<move,64>,64> quadratic_pv_{};
 	};
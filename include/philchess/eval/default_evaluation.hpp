@@ -16,30 +16,8 @@
 namespace philchess {
 namespace eval
 {
-	bool is_likely_drawn(const side_map<piece_type_map<unsigned>> counts) noexcept
-	{
-		if
-		(
-			counts[side::white][piece_type::pawn]==0 && counts[side::black][piece_type::pawn]==0 &&
-			counts[side::white][piece_type::queen]==0 && counts[side::black][piece_type::queen]==0
-		)
-		{
-			const auto black_minor = counts[side::black][piece_type::bishop]+counts[side::black][piece_type::knight];
-			const auto white_minor = counts[side::white][piece_type::bishop]+counts[side::white][piece_type::knight];
-				
-			if
-			(
-				(counts[side::white][piece_type::rook]==1 && counts[side::black][piece_type::rook]==0 && white_minor==0 && black_minor<3 && black_minor>0) ||
-				(counts[side::black][piece_type::rook]==1 && counts[side::white][piece_type::rook]==0 && black_minor==0 && white_minor<3 && white_minor>0)
-			)
-				return true;
-		}
-		
-		return false;
-	}
-	
-	template <typename EVAL_T, typename PARAMETERS_T>
-	EVAL_T default_evaluation(const chessboard& board, const PARAMETERS_T& parameters) noexcept
+	template <typename EVAL_T, typename PARAMETERS_T, typename PAWN_CACHE_T>
+	EVAL_T default_evaluation(const chessboard& board, const PARAMETERS_T& parameters, PAWN_CACHE_T& pawn_cache) noexcept
 	{
 		using ptl::popcount;
 		
@@ -47,28 +25,14 @@ namespace eval
 		const auto s=board.to_move_;
 		const auto opponent_s=reverse(s);
 		
-		side_map<piece_type_map<unsigned>> material_counts{};
-		piece_type_map<unsigned> total_material_counts{};
 		side_map<piece_type_map<unsigned>> kingsquare_attacker_counts{};
 		
-		for(const auto t: {piece_type::bishop, piece_type::knight, piece_type::rook, piece_type::queen})
-		{
-			material_counts[s][t]=popcount(board.piece_bitboard(s,t).ranks());
-			material_counts[opponent_s][t]=popcount(board.piece_bitboard(opponent_s,t).ranks());
-			
-			total_material_counts[t]=material_counts[s][t]+material_counts[opponent_s][t];
-		}
-		
-		material_counts[s][piece_type::pawn]=popcount(board.piece_bitboard(s,piece_type::pawn).ranks());
-		material_counts[opponent_s][piece_type::pawn]=popcount(board.piece_bitboard(opponent_s,piece_type::pawn).ranks());
-		
-		if(is_likely_drawn(material_counts))
+		const auto& material=lookup_material_info(board.material());
+		if(material.likely_drawn)
 			return 0;
 		
-		side_map<material_factor_key> material_keys{extract_and_compute_material_factor_key(material_counts[side::white]),extract_and_compute_material_factor_key(material_counts[side::black])}; //<--this might hide a bug like this, not entirely sure white is 0 and black is 1... for now i will simply overwrite it a line below, but thats only a temporary workaround while i am still developing this method...
-		material_keys[s]=extract_and_compute_material_factor_key(material_counts[s]);
-		material_keys[opponent_s]=extract_and_compute_material_factor_key(material_counts[opponent_s]);
-				
+		const auto& material_keys=material.keys;
+		
 		const auto evaluate_feature=[&, s, opponent_s](auto feature_function, auto factors)
 		{
 			const auto feature_s=feature_function(s);
@@ -100,14 +64,43 @@ namespace eval
 		
 		side_map<bitboard::rank> controlled{};
 		
-		const side_map<bitboard::rank> pawns = [&]()
+		//everything that only depends on the pawns, from whites point of view:
+		const auto& pawn_entry=pawn_cache.lookup(board.pawn_hash(),[&]()
 		{
-			side_map<bitboard::rank> ret_val;
-			ret_val[side::white]=board.piece_bitboard(side::white,piece_type::pawn);
-			ret_val[side::black]=board.piece_bitboard(side::black,piece_type::pawn);
+			typename PAWN_CACHE_T::entry_t ret_val{};
+			
+			side_map<bitboard::rank> pawns;
+			pawns[side::white]=board.piece_bitboard(side::white,piece_type::pawn);
+			pawns[side::black]=board.piece_bitboard(side::black,piece_type::pawn);
+			ret_val.info=eval::analyse_pawn_structure(pawns);
+			
+			const auto& pawn_info=ret_val.info;
+			const auto number_of_isolated_pawns = [&](auto s) { return popcount(pawn_info.isolated[s].ranks()); };
+			const auto number_of_backwards_pawns = [&](auto s) { return popcount(pawn_info.backward[s].ranks()&(~pawn_info.isolated[s].ranks())); };
+			const auto number_of_doubled_pawns = [&](auto s) { return popcount(pawn_info.doubled[s].ranks()); };
+			const auto number_of_passed_pawns = [&](auto s) { return popcount(pawn_info.passed[s].ranks()); };
+			const auto number_of_connected_pawns = [&](auto s) { return popcount((pawn_info.attacks[s]&pawns[s]).ranks()); };
+			
+			const auto evaluate_pawn_feature=[&](auto feature_function, auto factors)
+			{
+				const int difference=feature_function(side::white)-feature_function(side::black);
+				ret_val.middlegame+=difference*factors.middlegame;
+				ret_val.endgame+=difference*factors.endgame;
+			};
+			
+			evaluate_pawn_feature(number_of_isolated_pawns, parameters.isolated_pawn_penalty);
+			evaluate_pawn_feature(number_of_backwards_pawns, parameters.backwards_pawn_penalty);
+			evaluate_pawn_feature(number_of_doubled_pawns, parameters.doubled_pawn_penalty);
+			evaluate_pawn_feature(number_of_passed_pawns, parameters.passed_pawn_bonus);
+			evaluate_pawn_feature(number_of_connected_pawns, parameters.connected_pawn_bonus);
+			
 			return ret_val;
-		}();
-		const auto pawn_info=eval::analyse_pawn_structure(pawns);
+		});
+		const auto& pawn_info=pawn_entry.info;
+		
+		const auto white_relative = s==side::white?1:-1;
+		middlegame_eval=middlegame_eval+white_relative*pawn_entry.middlegame;
+		endgame_eval=endgame_eval+white_relative*pawn_entry.endgame;
 		
 		const auto& occupied=board.side_occupancy_;
 		
@@ -144,27 +137,29 @@ namespace eval
 		controlled[opponent_s]|=opponent_kingsquares;	
 		controlled[opponent_s]|=pawn_info.attacks[reverse(s)];
 		
-		for(const auto t: {piece_type::pawn, piece_type::knight, piece_type::bishop, piece_type::rook, piece_type::queen})
+		//piece square tables, summed up incrementally by the board, unless they are not the ones it knows
+		if(parameters.board_sums_piece_square_tables)
 		{
-			for(const auto p: squares(board.piece_bitboard(s,t)))
-			{
-				middlegame_eval=middlegame_eval+parameters.piece_square_tables[s][t][p];
-				endgame_eval=endgame_eval+parameters.endgame_piece_square_tables[s][t][p];
-			}
-			
-			for(const auto p: squares(board.piece_bitboard(opponent_s,t)))
+			middlegame_eval=middlegame_eval+board.middlegame_pst(s)-board.middlegame_pst(opponent_s);
+			endgame_eval=endgame_eval+board.endgame_pst(s)-board.endgame_pst(opponent_s);
+		}
+		else
+		{
+			for(const auto t: {piece_type::pawn, piece_type::knight, piece_type::bishop, piece_type::rook, piece_type::queen, piece_type::king})
 			{
-				middlegame_eval=middlegame_eval-parameters.piece_square_tables[opponent_s][t][p];
-				endgame_eval=endgame_eval-parameters.endgame_piece_square_tables[opponent_s][t][p];
+				for(const auto sq: squares(board.piece_bitboard(s,t)))
+				{
+					middlegame_eval=middlegame_eval+parameters.middlegame_pst[s][t][sq];
+					endgame_eval=endgame_eval+parameters.endgame_pst[s][t][sq];
+				}
+				for(const auto sq: squares(board.piece_bitboard(opponent_s,t)))
+				{
+					middlegame_eval=middlegame_eval-parameters.middlegame_pst[opponent_s][t][sq];
+					endgame_eval=endgame_eval-parameters.endgame_pst[opponent_s][t][sq];
+				}
 			}
 		}
 				
-		middlegame_eval=middlegame_eval+parameters.piece_square_tables[s][piece_type::king][board.king_squares_[s]];
-		middlegame_eval=middlegame_eval-parameters.piece_square_tables[opponent_s][piece_type::king][board.king_squares_[opponent_s]];
-		
-		endgame_eval=endgame_eval+parameters.endgame_piece_square_tables[s][piece_type::king][board.king_squares_[s]];
-		endgame_eval=endgame_eval-parameters.endgame_piece_square_tables[opponent_s][piece_type::king][board.king_squares_[opponent_s]];
-				
 		side_map<material_factor_key> attacker_keys{extract_and_compute_material_factor_key(kingsquare_attacker_counts[side::white]),extract_and_compute_material_factor_key(kingsquare_attacker_counts[side::black])}; //<--this might hide a bug like this, not entirely sure white is 0 and black is 1... for now i will simply overwrite it a line below, but thats only a temporary workaround while i am still developing this method...
 		attacker_keys[s]=extract_and_compute_material_factor_key(kingsquare_attacker_counts[s]);
 		attacker_keys[opponent_s]=extract_and_compute_material_factor_key(kingsquare_attacker_counts[opponent_s]);
@@ -189,12 +184,6 @@ namespace eval
 
 		const static auto pawnshield_masks=eval::get_pawnshield_masks();
 		
-		const auto number_of_isolated_pawns = [&](auto s) { return popcount(pawn_info.isolated[s].ranks()); };
-		const auto number_of_backwards_pawns = [&](auto s) { return popcount(pawn_info.backward[s].ranks()&(~pawn_info.isolated[s].ranks())); };
-		const auto number_of_doubled_pawns = [&](auto s) { return popcount(pawn_info.doubled[s].ranks()); };
-		const auto number_of_passed_pawns = [&](auto s) { return popcount(pawn_info.passed[s].ranks()); };
-		const auto number_of_connected_pawns = [&](auto s) { return popcount((pawn_info.attacks[s]&board.piece_bitboard(s,piece_type::pawn)).ranks()); };
-		
 		const auto number_of_occupied_holes = [&](auto s) { return popcount((pawn_info.holes[reverse(s)]&(board.piece_bitboard(s,piece_type::knight))).ranks()); };
 		const auto number_of_rooks_on_open_files = [&](auto s) { return popcount((pawn_info.halfopen[s]&(board.piece_bitboard(s,piece_type::rook))).ranks()); };
 		
@@ -209,12 +198,6 @@ namespace eval
 		const auto secondary_pawnshield_value = [&](auto s) { return popcount(pawnshield_masks.secondary[s][board.king_squares_[s]].ranks()&board.piece_bitboard(s,piece_type::pawn).ranks()); }; 
 		const auto number_of_open_files_in_king_vicinity = [&](auto s) { return popcount(pawnshield_masks.primary[s][board.king_squares_[s]].ranks()&pawn_info.halfopen[s].ranks()); };
 		
-		evaluate_feature(number_of_isolated_pawns, parameters.isolated_pawn_penalty);
-		evaluate_feature(number_of_backwards_pawns, parameters.backwards_pawn_penalty);
-		evaluate_feature(number_of_doubled_pawns, parameters.doubled_pawn_penalty);
-		evaluate_feature(number_of_passed_pawns, parameters.passed_pawn_bonus);
-		evaluate_feature(number_of_connected_pawns, parameters.connected_pawn_bonus);
-		
 		evaluate_feature(number_of_occupied_holes, parameters.occupied_hole_bonus);
 		evaluate_feature(number_of_rooks_on_open_files, parameters.rook_on_open_file_bonus);
 		
@@ -230,7 +213,7 @@ namespace eval
 		
 		evaluate_opponent_material_scaled_feature(number_of_open_files_in_king_vicinity,parameters.number_of_open_files_in_king_vicinity_penalty);
 		
-		auto factor = (1.0*parameters.phase_factors[extract_and_compute_material_factor_key(total_material_counts)])/parameters.phase_factors[compute_material_factor_key({0,0,0,0})];
+		auto factor = (1.0*parameters.phase_factors[material.total_key])/parameters.phase_factors[compute_material_factor_key({0,0,0,0})];
 		
 		return phase_independent_eval+(1.0-factor)*middlegame_eval+factor*endgame_eval;
 	}
@@ -0,0 +1,63 @@
+#ifndef PHILCHESS_EVAL_EVAL_CACHE_H
+#define PHILCHESS_EVAL_EVAL_CACHE_H
+
+#include <philchess/zobrist.hpp>
+
+#include <atomic>
+#include <memory>
+#include <optional>
+
+#include <cstdint>
+
+namespace philchess {
+namespace eval
+{
+	/*
+		Remembers the last static evaluations by hash, as the search tends to ask for the same one several times in a row
+		(init_branch, stand pat, razoring...). An entry is one word: the upper half of the hash and the score, so it is
+		always read and written as a whole and may be shared between threads without any further care.
+		The lowest size_bits of the hash are implied by the index, the ones between them and the upper half are neither stored nor compared,
+		so with the default size two positions are told apart by 48 of their 64 bits. Plenty, a false hit costs no more than one wrong evaluation.
+	*/
+	template <std::size_t size_bits=16>
+	class eval_cache
+	{
+		public:
+		eval_cache():
+			slots_{std::make_unique<std::atomic<std::uint64_t>[]>(number_of_slots)}
+		{
+			for(std::size_t i=0;i<number_of_slots;++i)
+				slots_[i].store(0,std::memory_order_relaxed);
+		}
+
+		std::optional<int> probe(zobrist hash) const noexcept
+		{
+			const auto data=slots_[index(hash)].load(std::memory_order_relaxed);
+			if(data!=0 && (data>>32)==key(hash))
+				return static_cast<std::int32_t>(static_cast<std::uint32_t>(data));
+			return std::nullopt;
+		}
+
+		void store(zobrist hash, int eval) noexcept
+		{
+			slots_[index(hash)].store(std::uint64_t{key(hash)}<<32 | static_cast<std::uint32_t>(eval),std::memory_order_relaxed);
+		}
+		
+		void clear() noexcept
+		{
+			for(std::size_t i=0;i<number_of_slots;++i)
+				slots_[i].store(0,std::memory_order_relaxed);
+		}
+
+		private:
+		static constexpr std::size_t number_of_slots=std::size_t{1}<<size_bits;
+		
+		static std::size_t index(zobrist hash) noexcept { return hash.value()&(number_of_slots-1); }
+		static std::uint32_t key(zobrist hash) noexcept { return static_cast<std::uint32_t>(hash.value()>>32); }
+
+		std::unique_ptr<std::atomic<std::uint64_t>[]> slots_;
+	};
+
+}} //end namespace philchess::eval
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef PHILCHESS_EVAL_EVALUATION_PARAMETERS_H
+#define PHILCHESS_EVAL_EVALUATION_PARAMETERS_H
+
+#include <philchess/types.hpp>
+
+#include <philchess/eval/material.hpp>
+#include <philchess/eval/mobility.hpp>
+#include <philchess/eval/piece_square_table.hpp>
+
+namespace philchess {
+namespace eval
+{
+	struct factor_pair
+	{
+		int middlegame, endgame;
+	};
+
+	/*
+		Every weight default_evaluation knows of, by value, so that there can be more than one set of them at a time, which is what tools/tune needs.
+		The defaults are the tables in src/eval and the factors in src/eval/evaluation_parameters.cpp, all of which tools/tune writes anew.
+	*/
+	struct evaluation_parameters
+	{
+		piece_type_map<mobility_eval_table<int>> mobility_eval_tables;
+
+		castling_right_map<int> castling_eval;
+
+		factor_pair isolated_pawn_penalty;
+		factor_pair backwards_pawn_penalty;
+		factor_pair doubled_pawn_penalty;
+		factor_pair passed_pawn_bonus;
+		factor_pair connected_pawn_bonus;
+		factor_pair occupied_hole_bonus;
+		factor_pair rook_on_open_file_bonus;
+		factor_pair controlled_square_bonus;
+		factor_pair hanging_piece_penalty;
+
+		material_factors<int> castling_rights_factor;
+		material_factors<int> kingsquare_attacker_factor;
+		material_factors<int> primary_pawnshield_bonus;
+		material_factors<int> secondary_pawnshield_bonus;
+		material_factors<int> number_of_open_files_in_king_vicinity_penalty;
+
+		material_factors<int> phase_factors;
+
+		piece_square_table<int> middlegame_pst, endgame_pst;
+
+		//the board sums up the compiled in piece square tables as it goes. set this to false if the ones above are anything else, so that the evaluation sums them up itself
+		bool board_sums_piece_square_tables=true;
+	};
+
+	const evaluation_parameters& get_default_evaluation_parameters() noexcept;
+
+}} //end namespace philchess::eval
+
+#endif
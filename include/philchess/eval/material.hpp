@@ -1,10 +1,13 @@
 #ifndef PHILCHESS_EVAL_MATERIAL_H
 #define PHILCHESS_EVAL_MATERIAL_H
 
+#include <philchess/material_signature.hpp>
 #include <philchess/types.hpp>
 
 #include <ptl/handle.hpp>
 
+#include <vector>
+
 namespace philchess {
 namespace eval
 {
@@ -63,6 +66,23 @@ namespace eval
 		std::array<FACTOR_T, 2*3*3*3> factors{};
 	};
 	
+	//everything the evaluation needs to know about the material, so it does not have to count it again and again
+	struct material_info
+	{
+		bool likely_drawn;
+		side_map<material_factor_key> keys;
+		material_factor_key total_key;
+	};
+	
+	bool is_likely_drawn(const side_map<piece_type_map<unsigned>>& counts) noexcept;
+	
+	//indexed by material_signature::clipped_index()
+	const std::vector<material_info>& get_material_info_table();
+	
+	inline const material_info& lookup_material_info(material_signature material) noexcept
+	{
+		return get_material_info_table()[material.clipped_index()];
+	}
 
 }} //end namespace philchess::eval
 
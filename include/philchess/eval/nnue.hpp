@@ -0,0 +1,79 @@
+#ifndef PHILCHESS_EVAL_NNUE_H
+#define PHILCHESS_EVAL_NNUE_H
+
+#include <philchess/types.hpp>
+
+#include <ptl/fixed_capacity_vector.hpp>
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace philchess {
+namespace eval {
+namespace nnue
+{
+	/*
+		An efficiently updatable neural network in the format of the first Stockfish nets(HalfKP, 256x2-32-32), so that any of those can simply be loaded.
+
+		The input is one feature per piece(kings excluded), by its square, type and whether it is ours, once as seen from each side and relative to that sides own king.
+		A move only changes a handful of those, so the first layer, which is by far the largest, is not recomputed, but kept as an accumulator by the board(see chessboard::set_network)
+		and only updated by the rows of the features that changed, unless the own king moved, which changes all of them for that side.
+		The two halves, the side to move first, are then clipped to 0..127 and fed through two small hidden layers with 8 bit weights into the single output.
+
+		The kernels use AVX2 or SSSE3, whichever the cpu has(the Makefile builds with -march=native), and plain loops otherwise.
+		Define PHILCHESS_NNUE_SCALAR to use the plain loops anyway, they compute exactly the same.
+	*/
+	constexpr std::size_t number_of_features=64*641; //by own king square: 10 kinds of pieces on 64 squares, plus one unused feature
+	constexpr std::size_t half_dimensions=256;
+	constexpr std::size_t hidden_dimensions=32;
+
+	using feature_list=ptl::fixed_capacity_vector<std::uint32_t,32>;
+
+	struct alignas(64) half_accumulator
+	{
+		std::array<std::int16_t,half_dimensions> values;
+	};
+
+	struct accumulator
+	{
+		side_map<half_accumulator> halves;
+	};
+
+	struct network
+	{
+		half_accumulator feature_biases;
+		std::vector<half_accumulator> feature_weights; //one row per feature
+
+		alignas(64) std::array<std::int32_t,hidden_dimensions> hidden1_biases;
+		alignas(64) std::array<std::array<std::int8_t,2*half_dimensions>,hidden_dimensions> hidden1_weights;
+		alignas(64) std::array<std::int32_t,hidden_dimensions> hidden2_biases;
+		alignas(64) std::array<std::array<std::int8_t,hidden_dimensions>,hidden_dimensions> hidden2_weights;
+		std::int32_t output_bias;
+		alignas(64) std::array<std::int8_t,hidden_dimensions> output_weights;
+	};
+
+	//nullptr if the file cannot be read or is not a HalfKP 256x2-32-32 net
+	std::unique_ptr<network> load_network(const std::string& path);
+	bool save_network(const network& net, const std::string& path);
+
+	//the pieces are seen from the perspective of one side: black looks at the board turned around
+	inline std::uint32_t feature_index(side perspective, square own_king, side owner, piece_type type, square sq) noexcept
+	{
+		const auto orient=[perspective](square s){ return static_cast<std::uint32_t>(perspective==side::white?s.id():s.id()^63); };
+		return orient(sq)+1+64*(2*static_cast<std::uint32_t>(type)+(owner==perspective?0:1))+641*orient(own_king);
+	}
+
+	void refresh(const network& net, half_accumulator& half, const feature_list& features) noexcept;
+	void update(const network& net, const half_accumulator& before, half_accumulator& after, const feature_list& added, const feature_list& removed) noexcept;
+
+	//roughly in centipawns, from the point of view of the side to move
+	int evaluate(const network& net, const accumulator& acc, side to_move) noexcept;
+
+}}} //end namespace philchess::eval::nnue
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef PHILCHESS_EVAL_PAWN_HASH_H
+#define PHILCHESS_EVAL_PAWN_HASH_H
+
+#include <philchess/zobrist.hpp>
+
+#include <philchess/eval/pawn_structure.hpp>
+
+#include <vector>
+
+#include <cstddef>
+
+namespace philchess {
+namespace eval
+{
+	/*
+		The pawn structure changes rarely within a subtree, so its analysis and everything that depends on the pawns alone is cached by pawn hash.
+		Scores are stored from whites point of view, so that the same entry serves both sides.
+		Not shared between threads, every searcher has its own, so no need to be careful here.
+	*/
+	class pawn_hash_table
+	{
+		public:
+		struct entry_t
+		{
+			pawnstruct_info info;
+			int middlegame, endgame;
+		};
+
+		template <typename COMPUTE_FUN_T>
+		const entry_t& lookup(zobrist pawn_hash, COMPUTE_FUN_T compute_fun) noexcept
+		{
+			++probes_;
+
+			auto& slot=slots_[pawn_hash.value()&(slots_.size()-1)];
+			if(slot.valid && slot.pawn_hash==pawn_hash)
+			{
+				++hits_;
+				return slot.entry;
+			}
+
+			slot.entry=compute_fun();
+			slot.pawn_hash=pawn_hash;
+			slot.valid=true;
+			return slot.entry;
+		}
+
+		unsigned number_of_probes() const noexcept { return probes_; }
+		unsigned number_of_hits() const noexcept { return hits_; }
+		void reset_stats() noexcept { probes_=0; hits_=0; }
+
+		private:
+		struct slot_t
+		{
+			zobrist pawn_hash;
+			bool valid=false;
+			entry_t entry;
+		};
+
+		std::vector<slot_t> slots_{16*1024}; //a power of 2 please
+		unsigned probes_=0, hits_=0;
+	};
+
+}} //end namespace philchess::eval
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef PHILCHESS_MATERIAL_SIGNATURE_H
+#define PHILCHESS_MATERIAL_SIGNATURE_H
+
+#include <philchess/types.hpp>
+
+#include <algorithm>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace philchess
+{
+	/*
+		Number of pieces of each type and side, 4 bits each, packed into one word so that adding or removing a piece is a single addition.
+		Kings are not counted, there is always exactly one of each anyway ;-)
+
+		Evaluation does not care about the exact numbers, only about a couple of thresholds(see eval/material.hpp), so clipped_index()
+		maps the counts to a small dense index for table lookups: pawns 0-1, knights 0-3, bishops 0-3, rooks 0-2 and queens 0-1 per side.
+	*/
+	class material_signature
+	{
+		public:
+		static constexpr std::size_t number_of_clipped_indices_per_side=2*4*4*3*2;
+		static constexpr std::size_t number_of_clipped_indices=number_of_clipped_indices_per_side*number_of_clipped_indices_per_side;
+
+		constexpr void add(piece_type t, side s) noexcept
+		{
+			if(is_counted(t))
+				counts_+=std::uint64_t{1}<<shift(t,s);
+		}
+
+		constexpr void remove(piece_type t, side s) noexcept
+		{
+			if(is_counted(t))
+				counts_-=std::uint64_t{1}<<shift(t,s);
+		}
+
+		constexpr unsigned count(piece_type t, side s) const noexcept
+		{
+			return is_counted(t)?(counts_>>shift(t,s))&0xf:0;
+		}
+
+		constexpr std::size_t clipped_index() const noexcept
+		{
+			return clipped_side_index(side::white)+number_of_clipped_indices_per_side*clipped_side_index(side::black);
+		}
+
+		friend constexpr bool operator==(material_signature lhs, material_signature rhs) noexcept { return lhs.counts_==rhs.counts_; }
+		friend constexpr bool operator!=(material_signature lhs, material_signature rhs) noexcept { return !(lhs==rhs); }
+
+		private:
+		std::uint64_t counts_=0;
+
+		static constexpr bool is_counted(piece_type t) noexcept { return t!=piece_type::king && t!=piece_type::none; }
+		static constexpr unsigned shift(piece_type t, side s) noexcept { return 4*(2*static_cast<unsigned>(t)+static_cast<unsigned>(s)); }
+
+		constexpr std::size_t clipped_side_index(side s) const noexcept
+		{
+			return
+				std::min(count(piece_type::pawn,s),1u)+2*(
+				std::min(count(piece_type::knight,s),3u)+4*(
+				std::min(count(piece_type::bishop,s),3u)+4*(
+				std::min(count(piece_type::rook,s),2u)+3*(
+				std::min(count(piece_type::queen,s),1u)))));
+		}
+	};
+
+} //end namespace philchess
+
+#endif
@@ -0,0 +1,251 @@
+#ifndef PHILCHESS_MOVE_PICKER_H
+#define PHILCHESS_MOVE_PICKER_H
+
+#include <philchess/chessboard.hpp>
+#include <philchess/types.hpp>
+
+#include <philchess/eval/piece_square_table.hpp>
+#include <philchess/eval/see.hpp>
+
+#include <ptl/fixed_capacity_vector.hpp>
+
+#include <algorithm>
+#include <array>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace philchess
+{
+	/*
+		Hands out the moves of a position one at a time, best guesses first, and does only as much work as is needed to get there:
+		The hash move is tried before anything is generated at all, then the captures that do not lose material(picked one by one, most valuable victim first),
+		then the killers, then the quiet moves by history, which are only generated once everything before has failed to cut off, and finally the losing captures.
+
+		When in check, all evasions are generated right away instead, they are few and it is nice to know how many there are.
+		Otherwise the moves are only pseudo legal and whether they leave the king in check is looked at when they are handed out, most of them never are.
+		Define PHILCHESS_LEGAL_MOVE_GENERATION to generate legal moves only, as before, mostly to see whether this still pays off.
+		Iterates like a container, so that negamax does not have to know about any of this ;-)
+	*/
+	class move_picker
+	{
+		public:
+		using history_table=piece_type_map<square_table<unsigned>>;
+
+		move_picker(const chessboard& board, move hash_move, std::array<move,2> killers, const history_table& history) noexcept:
+			board_{board},
+			history_{history},
+			hash_move_{hash_move},
+			killers_{killers},
+			in_check_{board.is_in_check()}
+		{
+			if(in_check_)
+			{
+				for(const auto m: board_.list_moves())
+				{
+					if(is_noisy(m))
+						noisy_.push_back({m,capture_score(m)});
+					else
+						quiet_.push_back({m,quiet_score(m)});
+				}
+				number_of_evasions_=noisy_.size()+quiet_.size();
+			}
+		}
+
+		//the next move to try, or a null move if there are none left
+		move next() noexcept
+		{
+			switch(stage_)
+			{
+				case stage::hash_move:
+				{
+					stage_=stage::generate_captures;
+					if(is_valid(hash_move_))
+						return hash_move_;
+					[[fallthrough]];
+				}
+				case stage::generate_captures:
+				{
+					if(!in_check_)
+					{
+						for(const auto m: generate_noisy())
+							noisy_.push_back({m,capture_score(m)});
+					}
+					stage_=stage::good_captures;
+					[[fallthrough]];
+				}
+				case stage::good_captures:
+				{
+					while(current_<noisy_.size())
+					{
+						//selection instead of sorting, the first capture cuts off often enough that sorting the rest would be wasted
+						std::iter_swap(std::begin(noisy_)+current_,std::max_element(std::begin(noisy_)+current_,std::end(noisy_)));
+						const auto m=noisy_[current_++].m;
+
+						if(m==hash_move_)
+							continue;
+						if(!eval::see_gain(board_,m))
+						{
+							losing_captures_.push_back(m);
+							continue;
+						}
+						if(is_playable(m))
+							return m;
+					}
+					stage_=stage::killers;
+					[[fallthrough]];
+				}
+				case stage::killers:
+				{
+					while(current_killer_<killers_.size())
+					{
+						const auto m=killers_[current_killer_++];
+						if(m!=hash_move_ && (current_killer_==1 || m!=killers_[0]) && !is_noisy(m) && is_valid(m))
+							return m;
+					}
+					stage_=stage::generate_quiets;
+					[[fallthrough]];
+				}
+				case stage::generate_quiets:
+				{
+					if(!in_check_)
+					{
+						for(const auto m: generate_quiet())
+							quiet_.push_back({m,quiet_score(m)});
+					}
+					std::sort(std::begin(quiet_),std::end(quiet_),[](const auto& lhs, const auto& rhs){ return lhs.score>rhs.score; });
+					current_=0;
+					stage_=stage::quiets;
+					[[fallthrough]];
+				}
+				case stage::quiets:
+				{
+					while(current_<quiet_.size())
+					{
+						const auto m=quiet_[current_++].m;
+						if(m!=hash_move_ && m!=killers_[0] && m!=killers_[1] && is_playable(m))
+							return m;
+					}
+					current_=0;
+					stage_=stage::losing_captures;
+					[[fallthrough]];
+				}
+				case stage::losing_captures:
+				{
+					while(current_<losing_captures_.size())
+					{
+						const auto m=losing_captures_[current_++];
+						if(is_playable(m))
+							return m;
+					}
+					stage_=stage::done;
+					[[fallthrough]];
+				}
+				case stage::done:
+					break;
+			}
+			return move{};
+		}
+
+		//only ever true when in check, otherwise we simply do not know without generating everything
+		bool single_reply() const noexcept { return number_of_evasions_==1; }
+
+		struct sentinel{};
+
+		class iterator
+		{
+			public:
+			iterator(move_picker& picker) noexcept:
+				picker_{&picker},
+				current_{picker.next()}
+			{}
+
+			move operator*() const noexcept { return current_; }
+			iterator& operator++() noexcept { current_=picker_->next(); return *this; }
+
+			friend bool operator!=(const iterator& it, sentinel) noexcept { return it.current_!=move{}; }
+
+			private:
+			move_picker* picker_;
+			move current_;
+		};
+
+		iterator begin() noexcept { return iterator{*this}; }
+		sentinel end() const noexcept { return {}; }
+
+		private:
+		enum class stage: std::uint8_t
+		{
+			hash_move, generate_captures, good_captures, killers, generate_quiets, quiets, losing_captures, done
+		};
+
+		struct scored_move
+		{
+			move m;
+			int score;
+
+			friend bool operator<(const scored_move& lhs, const scored_move& rhs) noexcept { return lhs.score<rhs.score; }
+		};
+
+		const chessboard& board_;
+		const history_table& history_;
+
+		move hash_move_;
+		std::array<move,2> killers_;
+		bool in_check_;
+		std::size_t number_of_evasions_=0;
+
+		stage stage_=stage::hash_move;
+		std::size_t current_=0, current_killer_=0;
+
+		ptl::fixed_capacity_vector<scored_move,220> noisy_, quiet_;
+		ptl::fixed_capacity_vector<move,220> losing_captures_;
+
+		bool is_noisy(move m) const noexcept
+		{
+			return board_.piece_type_at(m.to())!=piece_type::none || m.type()==move_type::promotion || m.type()==move_type::en_passant;
+		}
+
+#if defined(PHILCHESS_LEGAL_MOVE_GENERATION)
+		ptl::fixed_capacity_vector<move,220> generate_noisy() const noexcept { return board_.list_noisy_moves(); }
+		ptl::fixed_capacity_vector<move,220> generate_quiet() const noexcept { return board_.list_quiet_moves(); }
+		bool is_playable(move) const noexcept { return true; }
+#else
+		ptl::fixed_capacity_vector<move,220> generate_noisy() const noexcept { return board_.list_pseudo_legal_noisy_moves(); }
+		ptl::fixed_capacity_vector<move,220> generate_quiet() const noexcept { return board_.list_pseudo_legal_quiet_moves(); }
+		bool is_playable(move m) const noexcept { return in_check_ || board_.leaves_king_safe(m); }
+#endif
+
+		bool is_valid(move m) const noexcept
+		{
+			if(m==move{})
+				return false;
+
+			if(in_check_)
+			{
+				const auto is_m=[m](const auto& scored){ return scored.m==m; };
+				return std::any_of(std::begin(noisy_),std::end(noisy_),is_m) || std::any_of(std::begin(quiet_),std::end(quiet_),is_m);
+			}
+			return board_.is_legal(m);
+		}
+
+		//most valuable victim, least valuable aggressor. en passant and quiet promotions have no victim on the target square, so they come last
+		int capture_score(move m) const noexcept
+		{
+			const static auto& piece_square_tables=eval::get_default_piece_square_table();
+
+			const auto to_move=board_.side_to_move();
+			const auto aggressor=piece_square_tables[to_move][board_.piece_type_at(m.from())][m.from()];
+			const auto victim=piece_square_tables[reverse(to_move)][board_.piece_type_at(m.to())][m.to()];
+			return victim*16384-aggressor; //the table values stay well below 16384, even for the king
+		}
+
+		int quiet_score(move m) const noexcept
+		{
+			return static_cast<int>(std::min(history_[board_.piece_type_at(m.from())][m.to()],1u<<30));
+		}
+	};
+
+} //end namespace philchess
+
+#endif
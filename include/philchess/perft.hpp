@@ -0,0 +1,80 @@
+#ifndef PHILCHESS_PERFT_H
+#define PHILCHESS_PERFT_H
+
+#include <philchess/chessboard.hpp>
+#include <philchess/types.hpp>
+#include <philchess/zobrist.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace philchess
+{
+	/*
+		Counts the leaf nodes of the legal move tree up to the given depth, the one and only way to really know the move generator
+		(and do_move/undo_move) is right, as well as a decent measure of their raw speed. The last ply is not actually played,
+		the number of legal moves is all we need there.
+	*/
+
+	/*
+		Subtree counts by hash and depth. Shared by all threads, so an entry is two words, where the first is the hash xored with the second,
+		which holds the count and the depth. If another thread wrote one of them in between, the xor no longer matches and the entry is simply a miss.
+	*/
+	class perft_hash_table
+	{
+		public:
+		explicit perft_hash_table(std::size_t size_in_mb);
+
+		std::optional<std::uint64_t> probe(zobrist hash, unsigned depth) const noexcept
+		{
+			const auto& entry=entries_[hash.value()&(number_of_entries_-1)];
+			const auto data=entry.data.load(std::memory_order_relaxed);
+			const auto key=entry.key.load(std::memory_order_relaxed);
+			if((key^data)==hash.value() && (data&0xff)==depth)
+				return data>>8;
+			return std::nullopt;
+		}
+
+		void store(zobrist hash, unsigned depth, std::uint64_t nodes) noexcept
+		{
+			auto& entry=entries_[hash.value()&(number_of_entries_-1)];
+			const auto data=nodes<<8|depth;
+			entry.key.store(hash.value()^data,std::memory_order_relaxed);
+			entry.data.store(data,std::memory_order_relaxed);
+		}
+
+		private:
+		struct entry_t
+		{
+			std::atomic<std::uint64_t> key{0}, data{0};
+		};
+
+		std::size_t number_of_entries_;
+		std::unique_ptr<entry_t[]> entries_;
+	};
+
+	struct perft_options
+	{
+		unsigned threads=1;
+		std::size_t hash_size_in_mb=0; //0 for no hashing at all
+	};
+
+	struct perft_result
+	{
+		std::uint64_t nodes=0;
+		std::vector<std::pair<move,std::uint64_t>> divide; //the number of nodes below every root move, in move generation order
+		std::chrono::milliseconds elapsed{0};
+	};
+
+	perft_result perft(const chessboard& board, unsigned depth, perft_options options={});
+
+} //end namespace philchess
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef PHILCHESS_POSITION_RECORD_H
+#define PHILCHESS_POSITION_RECORD_H
+
+#include <philchess/types.hpp>
+
+#include <array>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace philchess
+{
+	class chessboard;
+
+	enum class game_result: std::uint8_t
+	{
+		black_wins=0, draw=1, white_wins=2, unknown=3
+	};
+
+	/*
+		One labelled position in 32 bytes, so that tens of millions of them fit into memory and can be read without parsing anything(see chessboard::setup(const position_record&)).
+		The pieces are packed into nibbles in the order of the squares in occupancy, lowest first: the piece type, plus 8 for black. 32 of them at most, so 16 bytes.
+		Files of them are simply the records one after the other, as they are in memory, which is little endian everywhere this is going to run ;-)
+	*/
+	struct position_record
+	{
+		static constexpr std::int16_t no_score=std::numeric_limits<std::int16_t>::min();
+
+		std::uint64_t occupancy;
+		std::array<std::uint8_t,16> pieces;
+		std::int16_t score; //from whites point of view, in centipawns, no_score if there is none
+		game_result result;
+		std::uint8_t flags; //side to move in bit 0, then whites castling rights in bits 1 and 2, blacks in bits 3 and 4
+		std::uint8_t enpassant_file; //8 if there is none
+		std::uint8_t fifty_move_counter;
+		std::array<std::uint8_t,2> reserved;
+
+		side side_to_move() const noexcept { return (flags&1)?side::black:side::white; }
+		castling_right castling_rights(side s) const noexcept { return static_cast<castling_right>((flags>>(s==side::white?1:3))&0x3); }
+		
+		//whether a board can be set up from it at all: at most 32 pieces, all of them real ones, one king each, an en passant file of at most 8(none) and a known result.
+		//Records straight from a file can be anything, chessboard::setup trusts them as it trusts a FEN.
+		bool is_valid() const noexcept;
+	};
+	static_assert(sizeof(position_record)==32,"records are written and read as they are, so they had better not be padded");
+
+	position_record make_position_record(const chessboard& board, std::int16_t score=position_record::no_score, game_result result=game_result::unknown) noexcept;
+	
+	/*
+		A FEN, or an EPD with only the first four fields, followed by whatever is known about it: the result as 1-0, 0-1 or 1/2-1/2(quoted as in c9 "1-0"; or not) or as [1.0], [0.5], [0.0],
+		the score as ce, which is from the point of view of the side to move, as EPD has it, and the fifty move counter as hmvc, if there are no clocks.
+		nullopt if the line does not even start with a position. format_labelled_position writes such a line, FEN with clocks, c9 and ce if known.
+	*/
+	std::optional<position_record> parse_labelled_position(std::string_view line);
+	std::string format_labelled_position(const position_record& record);
+
+	class position_record_writer
+	{
+		public:
+		explicit position_record_writer(const std::string& path, bool append=false);
+
+		bool write(const position_record& record);
+		bool write(const position_record* records, std::size_t count);
+		bool flush();
+
+		explicit operator bool() const noexcept { return static_cast<bool>(out_); }
+
+		private:
+		std::ofstream out_;
+	};
+
+	/*
+		A file of records mapped into memory read only, so nothing is copied and the operating system pages in as much as is actually read.
+		Falls back to reading it all where there is no mmap. The records are handed out as they are in the file, check is_valid before setting up a board from one.
+	*/
+	class position_record_file
+	{
+		public:
+		explicit position_record_file(const std::string& path);
+		~position_record_file();
+
+		position_record_file(const position_record_file&)=delete;
+		position_record_file& operator=(const position_record_file&)=delete;
+
+		//false if the file could not be opened or is no whole number of records long
+		bool is_open() const noexcept { return open_; }
+
+		std::size_t size() const noexcept { return size_; }
+		const position_record& operator[](std::size_t index) const noexcept { return records_[index]; }
+		const position_record* begin() const noexcept { return records_; }
+		const position_record* end() const noexcept { return records_+size_; }
+
+		private:
+		const position_record* records_=nullptr;
+		std::size_t size_=0;
+		bool open_=false;
+		void* mapping_=nullptr;
+		std::size_t mapping_size_=0;
+		std::vector<position_record> fallback_;
+	};
+
+} //end namespace philchess
+
+#endif
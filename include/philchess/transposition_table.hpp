@@ -0,0 +1,259 @@
+#ifndef PHILCHESS_TRANSPOSITION_TABLE_H
+#define PHILCHESS_TRANSPOSITION_TABLE_H
+
+#include <philchess/types.hpp>
+#include <philchess/zobrist.hpp>
+
+#include <ptl/bit.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <optional>
+
+#include <cstdint>
+
+namespace philchess
+{
+	/*
+		Kept separate from the search control so that several searchers (see the Threads option) can share
+		one table. Each of them still owns its killers, history and pv, only this one is shared.
+		
+		An entry is a single atomic 64 bit word: 16 bits of the key, a 16 bit score, the move, the depth and 
+		the bound type together with a 6 bit search generation. The remaining key bits are implied by the bucket
+		index, which is taken from the upper bits of the hash, while the stored ones are the lowest 16. As the
+		whole entry is written and read at once, no other thread can ever see half of it, so no locks are needed. 
+		
+		Eight of those entries make up a cache line sized bucket. When storing, the entry that is least valuable gets replaced, 
+		where an entries value is its depth minus a penalty for every search(go) it has survived. This way a deep entry from 
+		the current search is no longer thrown away for some quiescence result, while old deep ones do not clog the table forever.
+		
+		Scores have to fit into 16 bits, mapping the search scores onto those is up to the user (see default_search_control).
+		
+		The memory is 64 byte aligned, so buckets never straddle cache lines. On request it is backed by huge pages, as
+		with a table of several gigabytes pretty much every single probe would otherwise miss the TLB. Where the os does not 
+		give us any, we silently fall back to normal pages, large_pages_in_use() tells what we actually got.
+	*/
+	class transposition_table
+	{
+		public:
+		struct entry_t{ std::int16_t eval=0; move best_or_refutation_move; score_type type; std::uint8_t depth=0; };
+		
+		transposition_table():
+			transposition_table(32)
+		{}
+		
+		explicit transposition_table(std::size_t max_size_in_mb, bool use_large_pages=false):
+			large_pages_requested_{use_large_pages}
+		{
+			resize(max_size_in_mb);
+		}
+		
+		void new_search() noexcept
+		{
+			generation_=generation_%max_generation+1; //never 0, that one marks empty entries
+		}
+
+		void store(zobrist zobrist_hash, std::int16_t eval, score_type type, move m, std::uint8_t depth) noexcept
+		{
+			if(size_==0)
+				return;
+			
+			auto& bucket=buckets_[index(zobrist_hash)];
+			const auto key=key_of(zobrist_hash);
+			
+			std::atomic<std::uint64_t>* replace=nullptr;
+			int replace_value=::std::numeric_limits<int>::max();
+			for(auto& slot:bucket.slots)
+			{
+				const auto data=slot.load(std::memory_order_relaxed);
+				
+				if(generation_of(data)!=0 && stored_key_of(data)==key)
+				{
+					//same position: keep the deeper result, unless it is stale or we have an exact score now
+					if(type!=score_type::exact && depth+2<unpack(data).depth && generation_of(data)==generation_)
+						return;
+					replace=&slot;
+					break;
+				}
+				
+				const auto value=unpack(data).depth-age_penalty*relative_age(data);
+				if(value<replace_value)
+				{
+					replace=&slot;
+					replace_value=value;
+				}
+			}
+			
+			replace->store(pack(key,{eval,m,type,depth},generation_),std::memory_order_relaxed);
+		}
+
+		std::optional<entry_t> probe(zobrist zobrist_hash, std::uint8_t min_depth) const noexcept
+		{
+			if(size_==0)
+				return std::nullopt;
+			
+			const auto& bucket=buckets_[index(zobrist_hash)];
+			const auto key=key_of(zobrist_hash);
+			for(const auto& slot:bucket.slots)
+			{
+				const auto data=slot.load(std::memory_order_relaxed);
+				if(stored_key_of(data)!=key || generation_of(data)==0)
+					continue;
+				
+				const auto entry=unpack(data);
+				if(entry.depth>=min_depth)
+					return entry;
+				return std::nullopt;
+			}
+			return std::nullopt;
+		}
+		
+		void prefetch(zobrist zobrist_hash) const noexcept
+		{
+#if defined(__GNUC__)
+			if(size_!=0)
+				__builtin_prefetch(&buckets_[index(zobrist_hash)]);
+#else
+			(void)zobrist_hash;
+#endif
+		}
+		
+		//Approximation of the table usage in per mille as uci wants it, just looks at the first 1000 entries of the current search.
+		unsigned hashfull() const noexcept
+		{
+			unsigned ret_val=0;
+			const auto number_of_buckets=std::min<std::size_t>(1000/bucket_size,size_);
+			if(number_of_buckets==0)
+				return 0;
+			for(std::size_t i=0;i<number_of_buckets;++i)
+			{
+				for(const auto& slot:buckets_[i].slots)
+				{
+					if(generation_of(slot.load(std::memory_order_relaxed))==generation_)
+						++ret_val;
+				}
+			}
+			return ret_val*1000/(number_of_buckets*bucket_size);
+		}
+
+		void reset() noexcept
+		{
+			for(std::size_t i=0;i<size_;++i)
+			{
+				for(auto& slot:buckets_[i].slots)
+					slot.store(0,std::memory_order_relaxed);
+			}
+		}
+
+		void resize(std::size_t max_size_in_mb)
+		{
+			const auto max_number_of_buckets = max_size_in_mb * 1024*1024 /sizeof(bucket_t);
+			const auto power2_number_of_buckets = ptl::bit_floor(std::max<std::size_t>(max_number_of_buckets,2)); //at least 2, so that the index shift below stays well defined
+
+			//free the old one first, we may not be able to hold both... and if even the new one alone is too much, allocate throws and leaves us empty, which store and probe cope with
+			buckets_ = bucket_ptr{nullptr,{0,alignof(bucket_t),page_type::normal}};
+			size_ = 0;
+			hash_bitsize_ = 0;
+			buckets_ = allocate(power2_number_of_buckets,large_pages_requested_);
+			size_ = power2_number_of_buckets;
+			hash_bitsize_ = ptl::bit_width(power2_number_of_buckets) - 1;
+			reset();
+		}
+
+		void use_large_pages(bool enabled)
+		{
+			large_pages_requested_=enabled;
+			resize(size_bytes()/(1024*1024));
+		}
+		
+		bool large_pages_in_use() const noexcept { return buckets_.get_deleter().type!=page_type::normal; }
+
+		std::size_t size_bytes() const noexcept { return size_*sizeof(bucket_t); }
+		std::size_t number_of_entries() const noexcept { return size_*bucket_size; }
+
+		private:
+		static constexpr std::size_t bucket_size=8;
+		struct alignas(64) bucket_t
+		{
+			std::array<std::atomic<std::uint64_t>,bucket_size> slots;
+		};
+		static_assert(sizeof(bucket_t)==64,"A bucket is supposed to fill exactly one cache line");
+		
+		enum class page_type { normal, transparent_huge, huge };
+		struct memory_deleter
+		{
+			std::size_t size_in_bytes, alignment;
+			page_type type;
+			
+			void operator()(bucket_t* buckets) const noexcept;
+		};
+		using bucket_ptr=std::unique_ptr<bucket_t[],memory_deleter>;
+		
+		static bucket_ptr allocate(std::size_t number_of_buckets, bool use_large_pages);
+		
+		static constexpr std::uint8_t max_generation=63;
+		static constexpr int age_penalty=8;
+		
+		// eval: bits 0-15, move: bits 16-31, depth: bits 32-39, type: 40-41, generation: 42-47, key: 48-63
+		static std::uint64_t pack(std::uint16_t key, const entry_t& entry, std::uint8_t generation) noexcept
+		{
+			return 
+				std::uint64_t{static_cast<std::uint16_t>(entry.eval)} |
+				std::uint64_t{entry.best_or_refutation_move.value()}<<16 |
+				std::uint64_t{entry.depth}<<32 |
+				std::uint64_t{static_cast<std::uint8_t>(entry.type)}<<40 |
+				std::uint64_t{generation}<<42 |
+				std::uint64_t{key}<<48;
+		}
+		
+		static entry_t unpack(std::uint64_t data) noexcept
+		{
+			entry_t ret_val;
+			ret_val.eval=static_cast<std::int16_t>(static_cast<std::uint16_t>(data));
+			ret_val.best_or_refutation_move=move::from_value(static_cast<std::uint16_t>(data>>16));
+			ret_val.depth=static_cast<std::uint8_t>(data>>32);
+			ret_val.type=static_cast<score_type>((data>>40)&0x3);
+			return ret_val;
+		}
+		
+		static std::uint8_t generation_of(std::uint64_t data) noexcept
+		{
+			return static_cast<std::uint8_t>((data>>42)&0x3f);
+		}
+		
+		static std::uint16_t stored_key_of(std::uint64_t data) noexcept
+		{
+			return static_cast<std::uint16_t>(data>>48);
+		}
+		
+		static std::uint16_t key_of(zobrist zobrist_hash) noexcept
+		{
+			return static_cast<std::uint16_t>(zobrist_hash.value());
+		}
+		
+		int relative_age(std::uint64_t data) const noexcept
+		{
+			const auto generation=generation_of(data);
+			if(generation==0) //empty
+				return max_generation;
+			return (generation_+max_generation-generation)%max_generation;
+		}
+		
+		std::size_t index(zobrist zobrist_hash) const noexcept
+		{
+			return zobrist_hash.value()>>(64-hash_bitsize_);
+		}
+
+		bool large_pages_requested_=false;
+		bucket_ptr buckets_;
+		std::size_t size_=0;
+		std::size_t hash_bitsize_=0;
+		std::uint8_t generation_=1;
+	};
+
+} //end namespace philchess
+
+#endif
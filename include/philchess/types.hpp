@@ -127,7 +127,12 @@ namespace philchess
 		constexpr auto as_enpassant() const noexcept { auto cpy=*this; cpy.data|=static_cast<std::uint8_t>(move_type::en_passant)<<2; return cpy; } 
 		constexpr auto as_castle() const noexcept { auto cpy=*this; cpy.data|=static_cast<std::uint8_t>(move_type::castling)<<2; return cpy; } 
 		
+		//raw 16 bit representation, for anything that wants to store moves compactly(hash tables, files, ...)
+		constexpr auto value() const noexcept { return data; }
+		static constexpr move from_value(std::uint16_t value) noexcept { move ret_val; ret_val.data=value; return ret_val; }
+		
 		friend constexpr bool operator==(move lhs, move rhs) noexcept { return lhs.data==rhs.data; }
+		friend constexpr bool operator!=(move lhs, move rhs) noexcept { return !(lhs==rhs); }
 		
 		private:
 		std::uint16_t data;
@@ -69,6 +69,7 @@ namespace uci
 			{ "go"sv,			detail::call_helper_v<&ENGINE_T::go> },
 			{ "stop"sv,			detail::call_helper_v<&ENGINE_T::stop> },
 			{ "ponderhit"sv,	detail::call_helper_v<&ENGINE_T::ponderhit> },
+			{ "bench"sv,		detail::call_helper_v<&ENGINE_T::bench> },
 		});
 		
 		std::string line, cmd;
@@ -13,6 +13,8 @@
 #include <variant>
 #include <vector>
 
+#include <cstdint>
+
 namespace philchess {
 namespace uci
 {
@@ -205,6 +207,13 @@ namespace uci
 		return in;
 	}
 	
+	//not part of uci, but pretty much every engine understands "go perft <depth>"
+	struct perft_settings
+	{
+		unsigned depth;
+		bool divide=false;
+	};
+	
 	struct search_settings
 	{
 		philchess::side_map<std::optional<std::chrono::milliseconds>> remaining_time{};
@@ -212,7 +221,9 @@ namespace uci
 		
 		std::optional<unsigned> moves_to_go;
 		unsigned depth=41;
+		std::optional<std::uint64_t> nodes;
 		
+		std::optional<perft_settings> perft;
 	};
 	
 	inline std::istream& operator>>(std::istream& in, search_settings& settings) //see above, incomplete...
@@ -256,6 +267,20 @@ namespace uci
 				in>>depth;
 				settings.depth=depth;
 			}
+			else if(value=="nodes")
+			{
+				std::uint64_t nodes;
+				in>>nodes;
+				settings.nodes=nodes;
+			}
+			else if(value=="perft")
+			{
+				unsigned depth;
+				in>>depth;
+				settings.perft=perft_settings{depth};
+			}
+			else if(value=="divide" && settings.perft)
+				settings.perft->divide=true;
 			else
 			{
 				in.setstate(std::ios_base::failbit);
@@ -279,9 +304,36 @@ namespace uci
 		if(opt.moves_to_go)
 			out<<*opt.moves_to_go<<" moves to go ";
 		out<<opt.depth<<" plies to search";
+		if(opt.nodes)
+			out<<" "<<*opt.nodes<<" nodes at most";
+		
+		if(opt.perft)
+			out<<" perft "<<opt.perft->depth<<(opt.perft->divide?" divide":"");
 		
 		return out;
 	}
+	
+	//not part of uci either: "bench [depth] [hash] [threads]" searches a fixed set of positions to a fixed depth
+	struct bench_settings
+	{
+		unsigned depth=12;
+		int hash_size_in_mb=16;
+		int threads=1;
+	};
+	
+	inline std::istream& operator>>(std::istream& in, bench_settings& settings)
+	{
+		//every value is optional, so failing to read one simply leaves the default
+		if(unsigned depth; in>>depth)
+			settings.depth=depth;
+		if(int hash_size_in_mb; in>>hash_size_in_mb)
+			settings.hash_size_in_mb=hash_size_in_mb;
+		if(int threads; in>>threads)
+			settings.threads=threads;
+		
+		in.clear();
+		return in;
+	}
 
 }} //end namespace philchess::uci
 
@@ -7,6 +7,8 @@
 
 #include <atomic>
 #include <functional>
+#include <map>
+#include <string>
 #include <thread>
 #include <type_traits>
 
@@ -43,6 +45,8 @@ namespace uci
 		
 		void ponderhit();
 		
+		void bench(bench_settings settings);
+		
 		private:
 		IO_T io_;
 		pcl::monitor<ENGINE_T> engine_; //only accessed from within the worker thread, so the monitor is actually one more mutex than strictly necessary, but it ensures i dont do anything wrong here and I really dont trust myself with this xD...
@@ -53,6 +57,8 @@ namespace uci
 		
 		std::atomic<debug_setting> debug_{debug_setting::disabled};
 		
+		std::map<std::string,std::string,std::less<>> option_values_; //as last set, for bench to put them back. only ever touched from the thread reading the commands
+		
 		class engine_io;
 		
 		template <std::size_t... idxs>
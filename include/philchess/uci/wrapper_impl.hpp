@@ -6,10 +6,20 @@
 	reason it is not inside wrapper.h is for readability purposes ;-);
 */
 
+#include <philchess/uci/bench_positions.hpp>
+
 #include <ptl/typelist.hpp>
 
+#include <algorithm>
 #include <charconv>
+#include <chrono>
+#include <future>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+
+#include <cstdint>
 
 namespace philchess {
 namespace uci
@@ -55,6 +65,18 @@ class wrapper<ENGINE_T, IO_T>::engine_io
 		}
 	};
 	
+	struct printable_hashfull
+	{
+		std::optional<unsigned> hashfull;
+		
+		friend std::ostream& operator<<(std::ostream& out, const printable_hashfull& hashfull)
+		{
+			if(hashfull.hashfull)
+				out<<" hashfull "<<*(hashfull.hashfull);
+			return out;
+		}
+	};
+	
 	template <typename... T>
 	void debug_message(const T&... args)
 	{
@@ -63,10 +85,11 @@ class wrapper<ENGINE_T, IO_T>::engine_io
 	}
 	
 	template <typename SCORE_T, typename PV_T>
-	void report_pv(depth_info depth, std::chrono::milliseconds time, unsigned nodes, SCORE_T score, std::optional<SCORE_T> mate_distance, const PV_T& pv)
+	void report_pv(depth_info depth, std::chrono::milliseconds time, unsigned nodes, std::optional<unsigned> hashfull, SCORE_T score, std::optional<SCORE_T> mate_distance, const PV_T& pv)
 	{
 		printable_pv<PV_T> print_pv{pv};
 		printable_score<SCORE_T> print_score{score, mate_distance};
+		printable_hashfull print_hashfull{hashfull};
 		
 		io_.output(
 			"info depth ",depth.depth,
@@ -74,7 +97,8 @@ class wrapper<ENGINE_T, IO_T>::engine_io
 			print_score,
 			" time ",time.count(),
 			print_pv,
-			" nodes ",nodes
+			" nodes ",nodes,
+			print_hashfull
 		);
 	}
 	
@@ -188,7 +212,7 @@ void wrapper<ENGINE_T, IO_T>::setoption_impl(option opt, std::index_sequence<idx
 			for(const auto& entry:value_description.values)
 			{
 				if(opt.value==entry)
-					return std::optional<std::string>(std::move(opt.value));
+					return std::optional<std::string>(opt.value);
 			}
 			
 			io_.error("Combo entry not found ;_; ;_;");
@@ -200,7 +224,7 @@ void wrapper<ENGINE_T, IO_T>::setoption_impl(option opt, std::index_sequence<idx
 		}
 		else if constexpr(is_option<type,option_type::string>)
 		{
-			return std::optional<std::string>(std::move(opt.value));
+			return std::optional<std::string>(opt.value);
 		}
 		else
 		{
@@ -232,6 +256,7 @@ void wrapper<ENGINE_T, IO_T>::setoption_impl(option opt, std::index_sequence<idx
 						});
 						return true;
 					});
+					option_values_[opt.name]=opt.value;
 				}
 				else
 					io_.error("Option '",opt.name,"' found and parsed, but engine does not yet support it. Please implement set_option(",option_id,"...)");
@@ -284,6 +309,15 @@ void wrapper<ENGINE_T, IO_T>::position(board_position pos)
 	});
 }
 
+namespace go_detail
+{
+	template <typename engine_t>
+	constexpr auto engine_supports_perft(ptl::typelist<engine_t>) ->
+		decltype(std::declval<engine_t>().perft(std::declval<perft_settings>()),std::true_type{}) { return {}; }
+	
+	constexpr std::false_type engine_supports_perft(...) { return {}; }
+}
+
 template <typename ENGINE_T, typename IO_T>
 void wrapper<ENGINE_T, IO_T>::go(search_settings settings)
 {
@@ -292,6 +326,34 @@ void wrapper<ENGINE_T, IO_T>::go(search_settings settings)
 
 	should_stop_=false;
 	
+	if(settings.perft)
+	{
+		if constexpr(go_detail::engine_supports_perft(ptl::typelist<ENGINE_T>{}))
+		{
+			task_queue_.push([this, perft=*settings.perft]()
+			{
+				const auto result=engine_([&perft](ENGINE_T& engine)
+				{
+					return engine.perft(perft);
+				});
+				
+				if(perft.divide)
+				{
+					for(const auto& [m, nodes]: result.divide)
+						io_.output(m,": ",nodes);
+				}
+				
+				const auto ms=static_cast<std::uint64_t>(result.elapsed.count());
+				io_.output("info nodes ",result.nodes," time ",ms," nps ",result.nodes*1000/std::max<std::uint64_t>(ms,1));
+				io_.output("Nodes searched: ",result.nodes);
+				return true;
+			});
+		}
+		else
+			io_.error("perft is not implemented, as it is not needed for this engine ;-)\n");
+		return;
+	}
+	
 	task_queue_.push([this, settings]()
 	{	
 		struct control_t
@@ -321,5 +383,98 @@ void wrapper<ENGINE_T, IO_T>::ponderhit()
 	io_.error("ponderhit is not implemented yet, as it is not needed for my engine ;-)\n");
 }
 
+namespace bench_detail
+{
+	//only counts the nodes reported after every depth, the search output itself would just be noise here
+	struct counting_io
+	{
+		struct depth_info
+		{
+			unsigned depth, selective_depth;
+		};
+		
+		std::uint64_t& nodes;
+		
+		template <typename... T>
+		void debug_message(const T&...) {}
+		
+		template <typename HASHFULL_T, typename SCORE_T, typename MATE_DISTANCE_T, typename PV_T>
+		void report_pv(depth_info, std::chrono::milliseconds, unsigned depth_nodes, const HASHFULL_T&, const SCORE_T&, const MATE_DISTANCE_T&, const PV_T&)
+		{
+			nodes+=depth_nodes;
+		}
+	};
+}
+
+template <typename ENGINE_T, typename IO_T>
+void wrapper<ENGINE_T, IO_T>::bench(bench_settings settings)
+{
+	should_stop_=false;
+	
+	//whatever was set before(or the default, if nothing was) is put back once the bench is done
+	const auto current_value=[&](std::string_view name)
+	{
+		if(const auto it=option_values_.find(name);it!=std::end(option_values_))
+			return it->second;
+		
+		std::string ret_val;
+		for(const auto& description: ENGINE_T::option_list)
+		{
+			if(const auto spin=std::get_if<option_value<option_type::spin>>(&description.value); spin && description.name==name)
+				ret_val=std::to_string(spin->value);
+		}
+		return ret_val;
+	};
+	const auto previous_hash=current_value("Hash");
+	const auto previous_threads=current_value("Threads");
+	
+	setoption({"Hash",std::to_string(settings.hash_size_in_mb)});
+	setoption({"Threads",std::to_string(settings.threads)});
+	
+	std::promise<void> finished;
+	task_queue_.push([this, &finished, depth=settings.depth]()
+	{
+		std::uint64_t nodes=0;
+		struct control_t
+		{
+			const std::atomic<bool>& should_stop;
+			bench_detail::counting_io io;
+		} control{should_stop_,{nodes}};
+		
+		search_settings settings;
+		settings.depth=depth;
+		
+		const auto start_time=std::chrono::steady_clock::now();
+		engine_([&](ENGINE_T& engine)
+		{
+			engine.reset();
+			
+			std::size_t i=0;
+			for(const auto fen: bench_positions)
+			{
+				io_.output("info string bench position ",++i,"/",std::size(bench_positions),": ",fen);
+				engine.setup(fen);
+				engine.search(control,settings);
+			}
+		});
+		const auto ms=static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-start_time).count());
+		
+		io_.output("Total time (ms) : ",ms);
+		io_.output("Nodes searched  : ",nodes);
+		io_.output("Nodes/second    : ",nodes*1000/std::max<std::uint64_t>(ms,1));
+		
+		finished.set_value();
+		return true;
+	});
+	
+	//unlike go, this blocks until it is done, so that "bench" followed by "quit" behaves as expected
+	finished.get_future().wait();
+	
+	if(!previous_hash.empty())
+		setoption({"Hash",previous_hash});
+	if(!previous_threads.empty())
+		setoption({"Threads",previous_threads});
+}
+
 }} //end namespace philchess::uci
 #endif
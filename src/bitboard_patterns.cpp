@@ -1,174 +1,295 @@
 #include <philchess/bitboard_patterns.hpp>
 
+#include <ptl/bit.hpp>
+
+#include <utility>
+
 using namespace philchess;
 
-square_table<bitboard::rank> philchess::detail::compute_knight_attacks() noexcept
+namespace
 {
-	square_table<bitboard::rank> ret_val;
+	//found by trying sparse random numbers until one mapped all subsets without destructive collisions. tests/slider_attacks checks them
+	constexpr std::uint64_t rook_magics[64]=
+	{
+		0x0080011064804004ull, 0x8880200080104000ull, 0x0a80092000100084ull, 0x0500043000610008ull,
+		0x0100080010020500ull, 0x1200020001081004ull, 0x0280010002000280ull, 0x0200008324120041ull,
+		0x2081002100408000ull, 0x0002002100420080ull, 0x0800802000100080ull, 0x0001000821001000ull,
+		0x2040800400820800ull, 0x0082000802000410ull, 0x0091002900042a00ull, 0x0001002198430002ull,
+		0x0810908000400022ull, 0x0160890040010020ull, 0x8050002004002800ull, 0x0802420020120a00ull,
+		0x2040808004000802ull, 0x0102080120400410ull, 0xc100010100020004ull, 0x8800a20000904401ull,
+		0x0900802080004000ull, 0x0000200080400082ull, 0x00204b0100102000ull, 0x8016100080800800ull,
+		0x9cc6001200082004ull, 0x0232000404002010ull, 0x0220010080800200ull, 0xa880045e00011084ull,
+		0x0002400092800060ull, 0x2808400090802002ull, 0x0000201082004200ull, 0x0201100081802800ull,
+		0x8000040080800802ull, 0x0802008002801c00ull, 0x0001000401010200ull, 0x0004086092000504ull,
+		0x0040804000208000ull, 0x0080500020004000ull, 0x8210080024002000ull, 0x0004102042020008ull,
+		0x80020020046a0010ull, 0x0000020004008080ull, 0x1021000200010004ull, 0x140d004100820004ull,
+		0x8882208014410100ull, 0x0013450022008200ull, 0x8001200081100280ull, 0x001410010b002100ull,
+		0x202c810400880080ull, 0x0840040002008080ull, 0x0040418210080400ull, 0x0912004094210200ull,
+		0x2200c02111800501ull, 0x4006806040011101ull, 0x10c01200400a2082ull, 0x2008205001000845ull,
+		0x0012002110040802ull, 0x0003000400922811ull, 0x08440a0900981024ull, 0x000a00210c004482ull
+	};
 	
-	for(std::uint_fast8_t i=0;i<64;++i)
+	constexpr std::uint64_t bishop_magics[64]=
 	{
-		square sq{i};
-		
-		if(sq.file()+2<8 && sq.rank()+1<8)
-			ret_val[sq].set(square{sq.file()+2,sq.rank()+1});
-			
-		if(sq.file()+2<8 && sq.rank()-1>=0)
-			ret_val[sq].set(square{sq.file()+2,sq.rank()-1});
-			
-		if(sq.file()-2>=0 && sq.rank()+1<8)
-			ret_val[sq].set(square{sq.file()-2,sq.rank()+1});
-			
-		if(sq.file()-2>=0 && sq.rank()-1>=0)
-			ret_val[sq].set(square{sq.file()-2,sq.rank()-1});
-
-		if(sq.file()+1<8 && sq.rank()+2<8)
-			ret_val[sq].set(square{sq.file()+1,sq.rank()+2});
-			
-		if(sq.file()+1<8 && sq.rank()-2>=0)
-			ret_val[sq].set(square{sq.file()+1,sq.rank()-2});
-			
-		if(sq.file()-1>=0 && sq.rank()+2<8)
-			ret_val[sq].set(square{sq.file()-1,sq.rank()+2});
-			
-		if(sq.file()-1>=0 && sq.rank()-2>=0)
-			ret_val[sq].set(square{sq.file()-1,sq.rank()-2});
-		
+		0x0002880208204100ull, 0x006008088310c400ull, 0x3004280606400010ull, 0x0004104608010004ull,
+		0x0001104084021400ull, 0xa20609100a000000ull, 0x40008c0402404000ull, 0x000014008808086cull,
+		0x0000444450044508ull, 0x0013230401260201ull, 0x0004104102002008ull, 0x0810510400808140ull,
+		0x04000404200260c4ull, 0x0010488821080000ull, 0x0040009804032000ull, 0x52048a02092108b0ull,
+		0x0022119004010800ull, 0x0009481010008490ull, 0x1144208208020008ull, 0x4008015882004001ull,
+		0x0012100401200000ull, 0x00030002004a0224ull, 0x0044000080880820ull, 0x0401000024014c40ull,
+		0x0002600040a80288ull, 0x8114248110010800ull, 0x0010220010008600ull, 0x2a04040040401081ull,
+		0x300c082084002000ull, 0xc014042004100400ull, 0x10082040a08a0802ull, 0x0804a10086024206ull,
+		0x4822024201901000ull, 0x2008080881040180ull, 0x5081004044080080ull, 0x8520400a00002200ull,
+		0x4810008200222200ull, 0x1030020080080880ull, 0x0111180480020240ull, 0x3004088091042400ull,
+		0x4808080804080820ull, 0x0081080844120220ull, 0x0000820802040100ull, 0x0080002204200800ull,
+		0x0000044810100a00ull, 0x0240020046100102ull, 0x00081000c0800a10ull, 0x2508488428800441ull,
+		0x0289010802404400ull, 0x0042840908920000ull, 0x4944008401210001ull, 0x0048080084040800ull,
+		0xc4a0081020288020ull, 0x0080042950010080ull, 0x0004200222020001ull, 0x02e0041420404002ull,
+		0x8000440c11080204ull, 0x0050030421044200ull, 0x0052000042080401ull, 0x9090084a0020a800ull,
+		0x1001028050020880ull, 0xc080804010020087ull, 0x808a300b100c0084ull, 0x180801095a020200ull
 	};
 	
-	return ret_val;
-}
-
-square_table<bitboard::rank> philchess::detail::compute_king_attacks() noexcept
-{
-	square_table<bitboard::rank> ret_val;
+	enum class slider { rook, bishop };
 	
-	for(std::uint8_t i=0;i<64;++i)
+	struct slider_directions_t
 	{
-		square sq{i};
-		
-		if(sq.rank()+1<8) ret_val[sq].set(square{sq.file(),sq.rank()+1});
-		if(sq.file()+1<8 && sq.rank()+1<8) ret_val[sq].set(square{sq.file()+1,sq.rank()+1});
-		if(sq.file()-1>=0 && sq.rank()+1<8) ret_val[sq].set(square{sq.file()-1,sq.rank()+1});
-		if(sq.rank()-1>=0) ret_val[sq].set(square{sq.file(),sq.rank()-1});
-		if(sq.file()+1<8 && sq.rank()-1>=0) ret_val[sq].set(square{sq.file()+1,sq.rank()-1});
-		if(sq.file()-1>=0 && sq.rank()-1>=0) ret_val[sq].set(square{sq.file()-1,sq.rank()-1});
-		if(sq.file()+1<8) ret_val[sq].set(square{sq.file()+1,sq.rank()});
-		if(sq.file()-1>=0) ret_val[sq].set(square{sq.file()-1,sq.rank()});
+		int steps[4][2];
 	};
 	
-	return ret_val;
-}
-
-square_table<std::array<bitboard::rank,256>> philchess::detail::compute_rook_rank_attacks() noexcept
-{
-	square_table<std::array<bitboard::rank,256>> ret_val;
+	constexpr slider_directions_t directions_of(slider type) noexcept
+	{
+		if(type==slider::rook)
+			return {{{1,0},{-1,0},{0,1},{0,-1}}};
+		return {{{1,1},{-1,-1},{1,-1},{-1,1}}};
+	}
 	
-	for(std::uint_fast8_t id=0;id<64;++id)
+	constexpr std::uint64_t magic_of([[maybe_unused]] slider type, [[maybe_unused]] std::uint8_t id) noexcept
 	{
+#if defined(__BMI2__) && !defined(PHILCHESS_USE_MAGIC_BITBOARDS)
+		return 0;
+#else
+		return type==slider::rook?rook_magics[id]:bishop_magics[id];
+#endif
+	}
+	
+	constexpr bool is_on_board(int file, int rank) noexcept { return file>=0 && file<8 && rank>=0 && rank<8; }
+	constexpr bool towards_higher_ids(const int (&step)[2]) noexcept { return step[0]+8*step[1]>0; }
+	constexpr int lowest_bit(std::uint64_t bits) noexcept { return __builtin_ctzll(bits); }
+	constexpr int highest_bit(std::uint64_t bits) noexcept { return 63-__builtin_clzll(bits); }
+	
+	//every square in the given direction up to the edge of the board, for one square
+	struct rays_t
+	{
+		std::uint64_t by_direction[4];
+	};
+	
+	constexpr rays_t compute_rays(slider type, std::uint8_t id) noexcept
+	{
+		const auto directions=directions_of(type);
 		const auto sq=square{id};
 		
-		for(std::uint_fast16_t occupancy=0;occupancy<256;++occupancy)
+		rays_t ret_val{};
+		for(std::size_t d=0;d<4;++d)
 		{
-			for(int r=sq.rank()+1;r<8;++r)
-			{
-				ret_val[sq][occupancy].set(square(sq.file(),r));
-				if((occupancy>>r)&1)
-					break;
-			}
-			for(int r=sq.rank()-1;r>=0;--r)
-			{
-				ret_val[sq][occupancy].set(square(sq.file(),r));
-				if((occupancy>>r)&1)
-					break;
-			}
+			for(int file=sq.file()+directions.steps[d][0], rank=sq.rank()+directions.steps[d][1]; is_on_board(file,rank); file+=directions.steps[d][0], rank+=directions.steps[d][1])
+				ret_val.by_direction[d]|=std::uint64_t{1}<<square{file,rank}.id();
 		}
+		return ret_val;
 	}
 	
-	return ret_val;
-}
-
-square_table<std::array<bitboard::rank,256>> philchess::detail::compute_rook_file_attacks() noexcept
-{
-	square_table<std::array<bitboard::rank,256>> ret_val;
-	
-	for(std::uint_fast8_t id=0;id<64;++id)
+	//the last square of a ray is never relevant, nothing behind it to block
+	constexpr std::uint64_t relevant_mask(slider type, std::uint8_t id) noexcept
 	{
-		const auto sq=square{id};
+		const auto directions=directions_of(type);
+		const auto rays=compute_rays(type,id);
 		
-		for(std::uint_fast16_t occupancy=0;occupancy<256;++occupancy)
+		std::uint64_t ret_val=0;
+		for(std::size_t d=0;d<4;++d)
 		{
-			for(int f=sq.file()+1;f<8;++f)
-			{
-				ret_val[sq][occupancy].set(square(f,sq.rank()));
-				if((occupancy>>f)&1)
-					break;
-			}
-			for(int f=sq.file()-1;f>=0;--f)
-			{
-				ret_val[sq][occupancy].set(square(f,sq.rank()));
-				if((occupancy>>f)&1)
-					break;
-			}
+			if(const auto ray=rays.by_direction[d]; ray!=0)
+				ret_val|=ray&~(std::uint64_t{1}<<(towards_higher_ids(directions.steps[d])?highest_bit(ray):lowest_bit(ray)));
 		}
+		return ret_val;
 	}
 	
-	return ret_val;
-}
-
-square_table<std::array<bitboard::rank,256>> philchess::detail::compute_bishop_diagonal_attacks() noexcept
-{
-	square_table<std::array<bitboard::rank,256>> ret_val;
+	constexpr unsigned relevant_bits(slider type, std::uint8_t id) noexcept
+	{
+		return ptl::popcount(relevant_mask(type,id));
+	}
 	
-	for(std::uint_fast8_t id=0;id<64;++id)
+	/*
+		One table per square, the compiler refuses to evaluate all rook attacks in one go.
+		The first blocker on each ray is found with a bitscan and the part of the ray behind it is cut off, by removing the blocker's own ray in that direction.
+	*/
+	template <slider type, std::uint8_t id>
+	constexpr auto compute_square_attacks() noexcept
 	{
-		const auto sq=square{id};
+		std::array<bitboard::rank,std::size_t{1}<<relevant_bits(type,id)> ret_val{};
+		
+		const auto directions=directions_of(type);
+		const auto mask=relevant_mask(type,id);
+		const auto magic=magic_of(type,id);
+		const auto shift=64-relevant_bits(type,id);
+		
+		rays_t rays[64]{};
+		for(std::uint8_t other_id=0;other_id<64;++other_id)
+			rays[other_id]=compute_rays(type,other_id);
 		
-		for(std::uint_fast16_t occupancy=0;occupancy<256;++occupancy)
+		//enumerate all subsets of the mask(carry-rippler). They come in increasing order, which happens to be exactly the order pext maps them to
+		std::size_t n=0;
+		std::uint64_t subset=0;
+		do
 		{
-			for(auto file_up=sq.file()+1, rank_up=sq.rank()+1; file_up<8 && rank_up<8;++file_up, ++rank_up)
+			std::uint64_t attacks=0;
+			for(std::size_t d=0;d<4;++d)
 			{
-				ret_val[sq][occupancy].set(square(file_up,rank_up));
-				if((occupancy>>file_up)&1)
-					break;
+				auto ray=rays[id].by_direction[d];
+				if(const auto blockers=ray&subset; blockers!=0)
+					ray^=rays[towards_higher_ids(directions.steps[d])?lowest_bit(blockers):highest_bit(blockers)].by_direction[d];
+				attacks|=ray;
 			}
-			for(auto file_down=sq.file()-1, rank_down=sq.rank()-1; file_down>=0 && rank_down>=0;--file_down, --rank_down)
-			{
-				ret_val[sq][occupancy].set(square(file_down,rank_down));
-				if((occupancy>>file_down)&1)
-					break;
-			}
-		}
+			
+#if defined(__BMI2__) && !defined(PHILCHESS_USE_MAGIC_BITBOARDS)
+			const auto idx=n;
+			(void)magic;
+			(void)shift;
+#else
+			const auto idx=(subset*magic)>>shift;
+#endif
+			ret_val[idx]=bitboard::rank_index::from_ranks(attacks);
+			
+			subset=(subset-mask)&mask;
+			++n;
+		} while(subset!=0);
+		
+		return ret_val;
 	}
 	
-	return ret_val;
-}
+	template <slider type, std::uint8_t id>
+	constexpr auto square_attacks=compute_square_attacks<type,id>();
+	
+	template <slider type, std::size_t... ids>
+	constexpr auto compute_slider_entries(std::index_sequence<ids...>) noexcept
+	{
+		square_table<detail::slider_entry> ret_val{};
+		((ret_val[square{ids}]=detail::slider_entry{relevant_mask(type,ids),magic_of(type,ids),64-relevant_bits(type,ids),square_attacks<type,ids>.data()}),...);
+		return ret_val;
+	}
+	
+	constexpr auto compute_knight_attacks() noexcept
+	{
+		square_table<bitboard::rank> ret_val{};
+		
+		for(std::uint_fast8_t i=0;i<64;++i)
+		{
+			square sq{i};
+			
+			if(sq.file()+2<8 && sq.rank()+1<8)
+				ret_val[sq].set(square{sq.file()+2,sq.rank()+1});
+				
+			if(sq.file()+2<8 && sq.rank()-1>=0)
+				ret_val[sq].set(square{sq.file()+2,sq.rank()-1});
+				
+			if(sq.file()-2>=0 && sq.rank()+1<8)
+				ret_val[sq].set(square{sq.file()-2,sq.rank()+1});
+				
+			if(sq.file()-2>=0 && sq.rank()-1>=0)
+				ret_val[sq].set(square{sq.file()-2,sq.rank()-1});
 
-square_table<std::array<bitboard::rank,256>> philchess::detail::compute_bishop_antidiagonal_attacks() noexcept
-{
-	square_table<std::array<bitboard::rank,256>> ret_val;
+			if(sq.file()+1<8 && sq.rank()+2<8)
+				ret_val[sq].set(square{sq.file()+1,sq.rank()+2});
+				
+			if(sq.file()+1<8 && sq.rank()-2>=0)
+				ret_val[sq].set(square{sq.file()+1,sq.rank()-2});
+				
+			if(sq.file()-1>=0 && sq.rank()+2<8)
+				ret_val[sq].set(square{sq.file()-1,sq.rank()+2});
+				
+			if(sq.file()-1>=0 && sq.rank()-2>=0)
+				ret_val[sq].set(square{sq.file()-1,sq.rank()-2});
+			
+		};
+		
+		return ret_val;
+	}
 	
-	for(std::uint_fast8_t id=0;id<64;++id)
+	constexpr auto compute_king_attacks() noexcept
 	{
-		const auto sq=square{id};
+		square_table<bitboard::rank> ret_val{};
+		
+		for(std::uint8_t i=0;i<64;++i)
+		{
+			square sq{i};
+			
+			if(sq.rank()+1<8) ret_val[sq].set(square{sq.file(),sq.rank()+1});
+			if(sq.file()+1<8 && sq.rank()+1<8) ret_val[sq].set(square{sq.file()+1,sq.rank()+1});
+			if(sq.file()-1>=0 && sq.rank()+1<8) ret_val[sq].set(square{sq.file()-1,sq.rank()+1});
+			if(sq.rank()-1>=0) ret_val[sq].set(square{sq.file(),sq.rank()-1});
+			if(sq.file()+1<8 && sq.rank()-1>=0) ret_val[sq].set(square{sq.file()+1,sq.rank()-1});
+			if(sq.file()-1>=0 && sq.rank()-1>=0) ret_val[sq].set(square{sq.file()-1,sq.rank()-1});
+			if(sq.file()+1<8) ret_val[sq].set(square{sq.file()+1,sq.rank()});
+			if(sq.file()-1>=0) ret_val[sq].set(square{sq.file()-1,sq.rank()});
+		};
+		
+		return ret_val;
+	}
+	
+	constexpr auto compute_line_masks() noexcept
+	{
+		detail::line_masks ret_val{};
 		
-		for(std::uint_fast16_t occupancy=0;occupancy<256;++occupancy)
+		for(std::uint_fast8_t id=0;id<64;++id)
 		{
-			for(auto file_up=sq.file()+1, rank_down=sq.rank()-1; file_up<8 && rank_down>=0;++file_up, --rank_down)
+			const auto sq=square{id};
+			for(std::uint_fast8_t other_id=0;other_id<64;++other_id)
 			{
-				ret_val[sq][occupancy].set(square(file_up,rank_down));
-				if((occupancy>>file_up)&1)
-					break;
+				const auto other=square{other_id};
+				if(other==sq)
+					continue;
+				
+				if(other.file()==sq.file())
+					ret_val.files[sq].set(other);
+				if(other.rank()==sq.rank())
+					ret_val.ranks[sq].set(other);
+				if(other.diagonal()==sq.diagonal())
+					ret_val.diagonals[sq].set(other);
+				if(other.antidiagonal()==sq.antidiagonal())
+					ret_val.antidiagonals[sq].set(other);
 			}
-			for(auto file_down=sq.file()-1, rank_up=sq.rank()+1; file_down>=0 && rank_up<8;--file_down, ++rank_up)
+		}
+		
+		return ret_val;
+	}
+	
+	constexpr auto compute_between_masks() noexcept
+	{
+		square_table<square_table<bitboard::rank>> ret_val{};
+		
+		for(std::uint_fast8_t id=0;id<64;++id)
+		{
+			const auto sq=square{id};
+			for(std::uint_fast8_t other_id=0;other_id<64;++other_id)
 			{
-				ret_val[sq][occupancy].set(square(file_down,rank_up));
-				if((occupancy>>file_down)&1)
-					break;
+				const auto other=square{other_id};
+				const auto file_distance=other.file()-sq.file(), rank_distance=other.rank()-sq.rank();
+				if(other==sq || (file_distance!=0 && rank_distance!=0 && file_distance!=rank_distance && file_distance!=-rank_distance))
+					continue;
+				
+				const auto file_step=(file_distance>0)-(file_distance<0), rank_step=(rank_distance>0)-(rank_distance<0);
+				for(int file=sq.file()+file_step, rank=sq.rank()+rank_step;file!=other.file() || rank!=other.rank();file+=file_step, rank+=rank_step)
+					ret_val[sq][other].set(square{file,rank});
 			}
 		}
+		
+		return ret_val;
 	}
-	
-	return ret_val;
 }
 
+constexpr square_table<bitboard::rank> detail::knight_attacks=compute_knight_attacks();
+constexpr square_table<bitboard::rank> detail::king_attacks=compute_king_attacks();
+
+constexpr square_table<detail::slider_entry> detail::rook_attacks=compute_slider_entries<slider::rook>(std::make_index_sequence<64>{});
+constexpr square_table<detail::slider_entry> detail::bishop_attacks=compute_slider_entries<slider::bishop>(std::make_index_sequence<64>{});
+
+constexpr detail::line_masks detail::lines=compute_line_masks();
+constexpr square_table<square_table<bitboard::rank>> detail::between=compute_between_masks();
@@ -4,13 +4,21 @@
 #include <philchess/bitboard_patterns.hpp>
 #include <philchess/bitboard_range.hpp>
 #include <philchess/move_generator.hpp>
+#include <philchess/position_record.hpp>
 
+#include <philchess/eval/piece_square_table.hpp>
+
+#include <ptl/bit.hpp>
 #include <ptl/flatmap.hpp>
 
 #include <cctype>
+#include <cstdlib>
 
 namespace
 {	
+	const auto& middlegame_pst_table=philchess::eval::get_default_piece_square_table();
+	const auto& endgame_pst_table=philchess::eval::get_endgame_piece_square_table();
+	
 	constexpr auto castling_info(philchess::move m) noexcept
 	{
 		struct ret_val_t
@@ -42,6 +50,94 @@ namespace
 		return ret_val;
 	}
 	
+	//whether all three share a rank, file or diagonal
+	constexpr bool aligned(philchess::square a, philchess::square b, philchess::square c) noexcept
+	{
+		return
+			(a.file()==c.file() && b.file()==c.file()) ||
+			(a.rank()==c.rank() && b.rank()==c.rank()) ||
+			(a.diagonal()==c.diagonal() && b.diagonal()==c.diagonal()) ||
+			(a.antidiagonal()==c.antidiagonal() && b.antidiagonal()==c.antidiagonal());
+	}
+	
+	/*
+		Every reversible move(anything but a pawn move, on an otherwise empty board) by how it changes the hash, side to move included.
+		If the difference between the current hash and one from a few plies back is in here, a single move gets us back there.
+		Stored in a cuckoo hash table, so that a lookup is two probes at most. The idea and the hash functions are Marcel van Kervincks,
+		from "Detecting upcoming repetitions", and there are 3668 such moves, which fit comfortably into 8192 slots.
+	*/
+	struct cuckoo_table_t
+	{
+		static constexpr std::size_t size=8192;
+		
+		std::array<std::uint64_t,size> keys{};
+		std::array<philchess::move,size> moves{};
+		
+		static constexpr std::size_t h1(std::uint64_t key) noexcept { return key&(size-1); }
+		static constexpr std::size_t h2(std::uint64_t key) noexcept { return (key>>16)&(size-1); }
+	};
+	
+	constexpr auto make_cuckoo_table() noexcept
+	{
+		using namespace philchess;
+		
+		constexpr auto reaches=[](piece_type type, square from, square to)
+		{
+			const auto file_distance=from.file()>to.file()?from.file()-to.file():to.file()-from.file();
+			const auto rank_distance=from.rank()>to.rank()?from.rank()-to.rank():to.rank()-from.rank();
+			const auto straight=from.file()==to.file() || from.rank()==to.rank();
+			const auto diagonal=from.diagonal()==to.diagonal() || from.antidiagonal()==to.antidiagonal();
+			switch(type)
+			{
+				case piece_type::knight: return (file_distance==1 && rank_distance==2) || (file_distance==2 && rank_distance==1);
+				case piece_type::bishop: return diagonal;
+				case piece_type::rook: return straight;
+				case piece_type::queen: return straight || diagonal;
+				case piece_type::king: return file_distance<=1 && rank_distance<=1;
+				default: return false;
+			}
+		};
+		
+		cuckoo_table_t table;
+		for(const auto s: {side::white, side::black})
+		{
+			for(const auto type: {piece_type::knight, piece_type::bishop, piece_type::rook, piece_type::queen, piece_type::king})
+			{
+				for(std::uint8_t from=0;from<64;++from)
+				{
+					for(std::uint8_t to=from+1;to<64;++to)
+					{
+						if(!reaches(type,square{from},square{to}))
+							continue;
+						
+						zobrist hash;
+						hash.update(type,square{from},s);
+						hash.update(type,square{to},s);
+						hash.update_side();
+						
+						//kick out whatever is in the way, until everything has a place. no std::swap, that is not constexpr yet...
+						auto key=hash.value();
+						auto m=move{square{from},square{to}};
+						auto idx=cuckoo_table_t::h1(key);
+						while(m!=move{})
+						{
+							const auto displaced_key=table.keys[idx];
+							const auto displaced_move=table.moves[idx];
+							table.keys[idx]=key;
+							table.moves[idx]=m;
+							key=displaced_key;
+							m=displaced_move;
+							idx=idx==cuckoo_table_t::h1(key)?cuckoo_table_t::h2(key):cuckoo_table_t::h1(key);
+						}
+					}
+				}
+			}
+		}
+		return table;
+	}
+	
+	constexpr auto cuckoo_table=make_cuckoo_table();
+	
 } //end anonymous namespace...
 
 using namespace philchess;
@@ -109,6 +205,60 @@ zobrist chessboard::calculate_zobrist_hash() const noexcept
 	return ret_val;
 }
 
+zobrist chessboard::calculate_pawn_hash() const noexcept
+{
+	zobrist ret_val;
+	for(const auto s: {side::white, side::black})
+	{
+		for(const auto sq: squares(piece_bitboard(s,piece_type::pawn)))
+			ret_val.update(piece_type::pawn, sq, s);
+	}
+	return ret_val;
+}
+
+material_signature chessboard::calculate_material_signature() const noexcept
+{
+	material_signature ret_val;
+	for(const auto s: {side::white, side::black})
+	{
+		for(const auto t: {piece_type::pawn, piece_type::knight, piece_type::bishop, piece_type::rook, piece_type::queen})
+		{
+			for([[maybe_unused]] const auto sq: squares(piece_bitboard(s,t)))
+				ret_val.add(t, s);
+		}
+	}
+	return ret_val;
+}
+
+void chessboard::calculate_pst_sums(side_map<int>& middlegame, side_map<int>& endgame) const noexcept
+{
+	for(const auto s: {side::white, side::black})
+	{
+		middlegame[s]=endgame[s]=0;
+		for(const auto t: {piece_type::pawn, piece_type::knight, piece_type::bishop, piece_type::rook, piece_type::queen, piece_type::king})
+		{
+			for(const auto sq: squares(piece_bitboard(s,t)))
+			{
+				middlegame[s]+=middlegame_pst_table[s][t][sq];
+				endgame[s]+=endgame_pst_table[s][t][sq];
+			}
+		}
+	}
+}
+
+bool chessboard::incremental_state_is_consistent() const noexcept
+{
+	side_map<int> middlegame, endgame;
+	calculate_pst_sums(middlegame, endgame);
+	
+	return
+		zobrist_hash_==calculate_zobrist_hash() &&
+		pawn_hash_==calculate_pawn_hash() &&
+		material_==calculate_material_signature() &&
+		middlegame[side::white]==middlegame_pst_[side::white] && middlegame[side::black]==middlegame_pst_[side::black] &&
+		endgame[side::white]==endgame_pst_[side::white] && endgame[side::black]==endgame_pst_[side::black];
+}
+
 void chessboard::setup(std::string_view fen_string)
 {
 	struct board_piece {piece_type type; side s; };
@@ -203,25 +353,193 @@ void chessboard::setup(std::string_view fen_string)
 		fifty_move_counter_=fifty_move_counter_*10+(fen_string[n]-'0');
 	
 	//ignore fullmove num, not needed
+	
+	compute_derived_state();
+}
+
+void chessboard::setup(const position_record& record) noexcept
+{
+	std::fill(std::begin(data_),std::end(data_),piece_type::none);
+	
+	piece_bitboards_={};
+	side_occupancy_={};
+	occupancy_=bitboard::rank::from_ranks(record.occupancy);
+	
+	std::size_t index=0;
+	for(const auto sq: squares(occupancy_))
+	{
+		const auto nibble=(record.pieces[index/2]>>(index%2==0?0:4))&0xf;
+		const auto type=static_cast<piece_type>(nibble&0x7);
+		const auto s=(nibble&0x8)?side::black:side::white;
+		++index;
 		
-	played_moves_.clear();
-	hashes_.clear();
+		data_[sq]=type;
+		side_occupancy_[s].set(sq);
+		piece_bitboards_[type].set(sq);
+		if(type==piece_type::king)
+			king_squares_[s]=sq;
+	}
+	
+	to_move_=record.side_to_move();
+	castling_rights_[side::white]=record.castling_rights(side::white);
+	castling_rights_[side::black]=record.castling_rights(side::black);
+	enpassant_file_=record.enpassant_file;
+	fifty_move_counter_=record.fifty_move_counter;
+	
+	compute_derived_state();
+}
+
+std::string chessboard::fen() const
+{
+	std::string ret_val;
+	for(int rank=7;rank>=0;--rank)
+	{
+		int empty=0;
+		for(int file=0;file<8;++file)
+		{
+			const square sq{rank*8+file};
+			const auto type=piece_type_at(sq);
+			if(type==piece_type::none)
+			{
+				++empty;
+				continue;
+			}
+			
+			if(empty>0)
+				ret_val+=static_cast<char>('0'+empty);
+			empty=0;
+			
+			constexpr char letters[]="pnbrqk";
+			const auto letter=letters[static_cast<std::uint8_t>(type)];
+			ret_val+=owner_at(sq)==side::white?static_cast<char>(std::toupper(letter)):letter;
+		}
+		if(empty>0)
+			ret_val+=static_cast<char>('0'+empty);
+		if(rank>0)
+			ret_val+='/';
+	}
+	
+	ret_val+=to_move_==side::white?" w ":" b ";
+	
+	const auto has=[&](side s, castling_right right){ return (static_cast<std::uint8_t>(castling_rights_[s])&static_cast<std::uint8_t>(right))!=0; };
+	const auto castling_size=ret_val.size();
+	if(has(side::white,castling_right::kingside)) ret_val+='K';
+	if(has(side::white,castling_right::queenside)) ret_val+='Q';
+	if(has(side::black,castling_right::kingside)) ret_val+='k';
+	if(has(side::black,castling_right::queenside)) ret_val+='q';
+	if(ret_val.size()==castling_size)
+		ret_val+='-';
+	
+	if(enpassant_file_<8)
+	{
+		ret_val+=' ';
+		ret_val+=static_cast<char>('a'+enpassant_file_);
+		ret_val+=to_move_==side::white?'6':'3';
+	}
+	else
+		ret_val+=" -";
+	
+	ret_val+=' '+std::to_string(fifty_move_counter_)+" 1";
+	return ret_val;
+}
+
+void chessboard::compute_derived_state() noexcept
+{
+	plies_=0;
 	
 	zobrist_hash_=calculate_zobrist_hash();
+	pawn_hash_=calculate_pawn_hash();
+	material_=calculate_material_signature();
+	calculate_pst_sums(middlegame_pst_, endgame_pst_);
 	
 	check_inf_=compute_initial_check_info();
+	pin_inf_=compute_pin_info();
+	
+	if(network_)
+	{
+		refresh_accumulator(side::white);
+		refresh_accumulator(side::black);
+	}
+}
+
+void chessboard::set_network(const eval::nnue::network* net)
+{
+	network_=net;
+	if(!network_)
+	{
+		accumulators_.clear();
+		return;
+	}
+	
+	accumulators_.resize(history_size);
+	refresh_accumulator(side::white);
+	refresh_accumulator(side::black);
+}
+
+void chessboard::refresh_accumulator(side perspective) noexcept
+{
+	eval::nnue::feature_list features;
+	for(const auto sq: squares(occupancy_&~piece_bitboards_[piece_type::king]))
+		features.push_back(eval::nnue::feature_index(perspective,king_squares_[perspective],owner_at(sq),piece_type_at(sq),sq));
+	eval::nnue::refresh(*network_,accumulators_[plies_%history_size].halves[perspective],features);
+}
+
+//at the very end of do_move, the mover is no longer to move
+void chessboard::update_accumulators(philchess::move m, piece_type moved_piece, piece_type captured) noexcept
+{
+	const auto mover=reverse(to_move_);
+	const auto& before=accumulators_[(plies_-1)%history_size];
+	auto& after=accumulators_[plies_%history_size];
+	
+	for(const auto perspective: {side::white, side::black})
+	{
+		if(moved_piece==piece_type::king && perspective==mover) //every single feature depends on where the own king is
+		{
+			refresh_accumulator(perspective);
+			continue;
+		}
+		
+		const auto feature=[&](side owner, piece_type type, square sq){ return eval::nnue::feature_index(perspective,king_squares_[perspective],owner,type,sq); };
+		
+		eval::nnue::feature_list added, removed;
+		if(moved_piece!=piece_type::king)
+		{
+			removed.push_back(feature(mover,moved_piece,m.from()));
+			added.push_back(feature(mover,m.type()==move_type::promotion?m.promote_to():moved_piece,m.to()));
+		}
+		else if(m.type()==move_type::castling)
+		{
+			const auto info=castling_info(m);
+			removed.push_back(feature(mover,piece_type::rook,info.rook_origin));
+			added.push_back(feature(mover,piece_type::rook,info.rook_destination));
+		}
+		
+		if(captured!=piece_type::none)
+			removed.push_back(feature(reverse(mover),captured,m.type()==move_type::en_passant?square{m.to().file(),m.from().rank()}:m.to()));
+		
+		eval::nnue::update(*network_,before.halves[perspective],after.halves[perspective],added,removed);
+	}
 }
 
 chessboard::undoable_move chessboard::do_move(philchess::move m) noexcept
 {	
+	auto& record=push_ply();
+	record.hash=zobrist_hash_;
+	record.fifty_move_counter=fifty_move_counter_;
+#if defined(PHILCHESS_COPY_MAKE)
+	record.state=*this;
+#else
+	record.pin_inf=pin_inf_;
+#endif
+	
 	const auto moved_piece=piece_type_at(m.from());
 	const auto moved_piece_owner = to_move_;
 	auto old_piece=piece_type_at(m.to());
 	const auto old_castling=castling_rights_;
 	const auto old_enpassant=enpassant_file_;
-	const auto old_zobrist=zobrist_hash_;
-	const auto old_movecount=fifty_move_counter_;
+#if !defined(PHILCHESS_COPY_MAKE)
 	const auto old_check_inf=check_inf_;
+#endif
 	
 	const auto change_castling_rights=[&](side s, castling_right new_rights)
 	{
@@ -325,18 +643,37 @@ chessboard::undoable_move chessboard::do_move(philchess::move m) noexcept
 	to_move_=reverse(to_move_);
 	zobrist_hash_.update_side();
 	
-	played_moves_.push_back(m);
-	hashes_.push_back(old_zobrist);
+	if(prefetch_fun_)
+		prefetch_fun_(prefetch_context_,zobrist_hash_);
+	
+	record.move=m;
+	record.captured=old_piece;
 	check_inf_=compute_check_info();
+	pin_inf_=compute_pin_info();
+	
+	if(network_)
+		update_accumulators(m,moved_piece,old_piece);
 		
-	return {m, old_piece, old_castling, old_enpassant, old_movecount, old_check_inf};
+#if defined(PHILCHESS_COPY_MAKE)
+	return {m};
+#else
+	return {m, old_castling, old_enpassant, old_check_inf};
+#endif
 }
 
+#if defined(PHILCHESS_COPY_MAKE)
+void chessboard::undo_move(undoable_move) noexcept
+{
+	static_cast<position_state&>(*this)=pop_ply().state;
+}
+#else
 void chessboard::undo_move(const undoable_move m) noexcept
 {
+	const auto& record=pop_ply();
+	
 	const auto moved_piece=m.move.type()==move_type::promotion?piece_type::pawn:piece_type_at(m.move.to());
 	const auto moved_piece_owner = owner_at(m.move.to());
-	set_piece(m.move.to(),m.old,reverse(moved_piece_owner));
+	set_piece(m.move.to(),record.captured,reverse(moved_piece_owner));
 	set_piece(m.move.from(),moved_piece,moved_piece_owner);
 	to_move_=reverse(to_move_);
 
@@ -351,11 +688,11 @@ void chessboard::undo_move(const undoable_move m) noexcept
 		unset_piece(m.move.to());
 		if(m.move.to().rank()==2)
 		{
-			set_piece(square{enpassant_file_, 3}, m.old,reverse(moved_piece_owner));
+			set_piece(square{enpassant_file_, 3}, record.captured,reverse(moved_piece_owner));
 		}
 		else if(m.move.to().rank()==5)
 		{
-			set_piece(square{enpassant_file_, 4}, m.old,reverse(moved_piece_owner));
+			set_piece(square{enpassant_file_, 4}, record.captured,reverse(moved_piece_owner));
 		}
 	}
 	
@@ -366,22 +703,26 @@ void chessboard::undo_move(const undoable_move m) noexcept
 		set_piece(info.rook_origin,piece_type::rook, moved_piece_owner);
 	}
 	
-	zobrist_hash_=hashes_.back();
+	zobrist_hash_=record.hash;
 	
-	fifty_move_counter_=m.old_movecount;
+	fifty_move_counter_=record.fifty_move_counter;
 	
 	check_inf_=m.check_inf;
-
-	hashes_.pop_back();
-	played_moves_.pop_back();
+	pin_inf_=record.pin_inf;
 }
+#endif
 
 chessboard::nullmove_data chessboard::do_nullmove() noexcept
 {
 	const auto old_enpassant=enpassant_file_;
-	const auto old_zobrist=zobrist_hash_;
-	const auto old_movecount=fifty_move_counter_;
 	const auto old_check_inf=check_inf_;
+	const auto old_pin_inf=pin_inf_;
+	
+	auto& record=push_ply();
+	record.hash=zobrist_hash_;
+	record.move=move{};
+	record.fifty_move_counter=fifty_move_counter_;
+	record.captured=piece_type::none;
 
 	fifty_move_counter_=0;
 
@@ -391,25 +732,30 @@ chessboard::nullmove_data chessboard::do_nullmove() noexcept
 	to_move_=reverse(to_move_);
 
 	zobrist_hash_.update_side();
-	played_moves_.push_back(move{});
-	hashes_.push_back(old_zobrist);
+	
+	if(prefetch_fun_)
+		prefetch_fun_(prefetch_context_,zobrist_hash_);
+	
 	check_inf_={};
+	pin_inf_=compute_pin_info(); //nothing moved, but the check squares are now those of the other side
+	
+	if(network_)
+		accumulators_[plies_%history_size]=accumulators_[(plies_-1)%history_size];
 
-	return {old_enpassant, old_movecount, old_check_inf};
+	return {old_enpassant, old_check_inf, old_pin_inf};
 }
 
 void chessboard::undo_nullmove(nullmove_data data) noexcept
 {
 	to_move_=reverse(to_move_);
 	enpassant_file_=data.old_enpassant;
-	zobrist_hash_=hashes_.back();
-
-	fifty_move_counter_=data.old_movecount;
+	
+	const auto& record=pop_ply();
+	zobrist_hash_=record.hash;
+	fifty_move_counter_=record.fifty_move_counter;
 
 	check_inf_=data.check_inf;
-
-	hashes_.pop_back();
-	played_moves_.pop_back();
+	pin_inf_=data.pin_inf;
 }
 
 template <typename T>
@@ -517,39 +863,7 @@ auto chessboard::checked_enpassant_move_adder(T& move_container, side opponent_s
 
 auto chessboard::generate_pinmap() const noexcept
 {
-	const auto opponent_side=reverse(to_move_);
-	const auto king_square=king_squares_[to_move_];
-
-	bitboard::rank attack_bishops_diagonal, attack_rooks_files;
-	bitboard::rank attack_bishops_antidiagonal, attack_rooks_ranks;
-	
-	for(const auto& p:squares(piece_bitboard(opponent_side,piece_type::bishop) | piece_bitboard(opponent_side,piece_type::queen)))
-	{
-		if(p.diagonal()==king_square.diagonal())
-			attack_bishops_diagonal|=attacked_by_bishop_on_diagonal(p,occupancy_);
-		else if(p.antidiagonal()==king_square.antidiagonal())
-			attack_bishops_antidiagonal|=attacked_by_bishop_on_antidiagonal(p,occupancy_);
-	}
-		
-	for(const auto& p:squares(piece_bitboard(opponent_side,piece_type::rook) | piece_bitboard(opponent_side,piece_type::queen)))
-	{
-		if(p.file()==king_square.file())
-			attack_rooks_files|=attacked_by_rook_on_file(p,occupancy_);
-		else if(p.rank()==king_square.rank())
-			attack_rooks_ranks|=attacked_by_rook_on_rank(p,occupancy_);
-	}
-	
-	bitboard::rank result;
-	if(attack_bishops_diagonal.ranks()!=0)
-		result|=attack_bishops_diagonal&attacked_by_bishop_on_diagonal(king_square,occupancy_);
-	if(attack_rooks_files.ranks()!=0)
-		result|=attack_rooks_files&attacked_by_rook_on_file(king_square,occupancy_);
-	if(attack_bishops_antidiagonal.ranks()!=0)
-		result|=attack_bishops_antidiagonal&attacked_by_bishop_on_antidiagonal(king_square,occupancy_);
-	if(attack_rooks_ranks.ranks()!=0)
-		result|=attack_rooks_ranks&attacked_by_rook_on_rank(king_square,occupancy_);
-				
-	return result.ranks();
+	return (pin_inf_.blockers[to_move_]&side_occupancy_[to_move_]).ranks();
 }
 
 ptl::fixed_capacity_vector<philchess::move,220> chessboard::list_moves() const noexcept 
@@ -790,6 +1104,16 @@ ptl::fixed_capacity_vector<philchess::move,220> chessboard::list_noisy_moves() c
 		
 		move_generator.capture<piece_type::king>(king_square,to_move_,add_checked_evasion);
 		
+		//...except for promotions, which are noisy even if all they do is get in the way. rare enough to just look for them in the full list
+		const auto seventh_rank=to_move_==side::white?std::uint64_t{0b11111111}<<48:std::uint64_t{0b11111111}<<8;
+		if((non_pinned_pawns.ranks()&seventh_rank)!=0)
+		{
+			for(const auto m: list_moves())
+			{
+				if(m.type()==move_type::promotion && piece_type_at(m.to())==piece_type::none)
+					legal_moves.push_back(m);
+			}
+		}
 	}
 	else
 	{	
@@ -861,6 +1185,305 @@ ptl::fixed_capacity_vector<philchess::move,220> chessboard::list_noisy_moves() c
 	return legal_moves;
 }
 
+ptl::fixed_capacity_vector<philchess::move,220> chessboard::list_quiet_moves() const noexcept
+{
+	if(check_inf_.in_check()) //evasions are few and rather special, so just take what is not noisy from the full list
+	{
+		ptl::fixed_capacity_vector<philchess::move,220> ret_val;
+		for(const auto m: list_moves())
+		{
+			if(piece_type_at(m.to())==piece_type::none && m.type()!=move_type::promotion && m.type()!=move_type::en_passant)
+				ret_val.push_back(m);
+		}
+		return ret_val;
+	}
+	
+	move_generator<board_proxy_t> move_generator{board_proxy_t{*this}};
+	
+	const auto opponent_side=reverse(to_move_);
+	
+	ptl::fixed_capacity_vector<philchess::move,220> legal_moves;
+	
+	const auto king_square=king_squares_[to_move_];
+	
+	const auto pinned_map=generate_pinmap();
+	
+	const auto bitboard_iter_for_nonpinned=[&](side s, piece_type type)
+	{
+		return squares(bitboard::rank_index::from_ranks(piece_bitboard(s,type).ranks()&(~pinned_map)));
+	};
+	const auto bitboard_iter_for_nonpinned_combined=[&](side s, piece_type type0, piece_type type1)
+	{
+		return squares
+		(
+			bitboard::rank_index::from_ranks(
+				(piece_bitboard(s,type0) | piece_bitboard(s,type1)).ranks()&(~pinned_map)
+			)
+		);
+	};
+	const auto bitboard_iter_for_pinned_combined=[&](side s, piece_type type0, piece_type type1)
+	{
+		return squares
+		(
+			bitboard::rank_index::from_ranks(
+				(piece_bitboard(s,type0) | piece_bitboard(s,type1)).ranks()&pinned_map
+			)
+		);
+	};
+	
+	const auto add_move=[&](auto m){ legal_moves.push_back(m); };
+	const auto add_checked_evasion=checked_evasion_move_adder(legal_moves,opponent_side);
+	const auto add_checked_castle=checked_castle_adder(legal_moves,opponent_side);
+	
+	for(const auto& p:bitboard_iter_for_nonpinned(to_move_,piece_type::knight))
+		move_generator.non_capture<piece_type::knight>(p,to_move_,add_move);
+	
+	//promotions are noisy, even without capturing anything
+	static const auto non_promotion_ranks = ~bitboard::rank{bitboard::rank_index::from_ranks((std::uint64_t{0b11111111}<<56) | std::uint64_t{0b11111111})};
+	
+	const auto non_pinned_pawns = piece_bitboard(to_move_,piece_type::pawn) & bitboard::rank{bitboard::rank_index::from_ranks(~pinned_map)};
+	const auto pinned_pawns = piece_bitboard(to_move_,piece_type::pawn) & bitboard::rank{bitboard::rank_index::from_ranks(pinned_map)};
+	
+	move_generator.non_capture_pawnset_targets(non_pinned_pawns,to_move_,non_promotion_ranks,add_move);
+	if(pinned_pawns.ranks()!=0)
+	{
+		move_generator.non_capture_pawnset_targets(pinned_pawns,to_move_,non_promotion_ranks,[&](auto m)
+		{
+			if(m.from().file()==king_square.file())
+				add_move(m);
+		});
+	}
+	
+	for(const auto& p:bitboard_iter_for_nonpinned_combined(to_move_,piece_type::rook,piece_type::queen))
+		move_generator.non_capture<piece_type::rook>(p,to_move_,add_move);
+	
+	for(const auto& p:bitboard_iter_for_pinned_combined(to_move_,piece_type::rook, piece_type::queen))
+	{
+		if(p.rank()==king_square.rank())
+			move_generator.non_capture_rank_rook(p,to_move_,add_move);
+		else if(p.file()==king_square.file())
+			move_generator.non_capture_file_rook(p,to_move_,add_move);
+	}
+	
+	for(const auto& p:bitboard_iter_for_nonpinned_combined(to_move_,piece_type::bishop,piece_type::queen))
+		move_generator.non_capture<piece_type::bishop>(p,to_move_,add_move);
+	
+	for(const auto& p:bitboard_iter_for_pinned_combined(to_move_,piece_type::bishop,piece_type::queen))
+	{
+		if(p.diagonal()==king_square.diagonal())
+			move_generator.non_capture_diagonal_bishop(p,to_move_,add_move);
+		else if(p.antidiagonal()==king_square.antidiagonal())
+			move_generator.non_capture_antidiagonal_bishop(p,to_move_,add_move);
+	}
+	
+	move_generator.king_castle(king_square,to_move_,add_checked_castle);
+	move_generator.all_king_without_castle(king_square,to_move_,[&](auto m)
+	{
+		if(piece_type_at(m.to())==piece_type::none)
+			add_checked_evasion(m);
+	});
+	
+	return legal_moves;
+}
+
+ptl::fixed_capacity_vector<philchess::move,220> chessboard::list_pseudo_legal_noisy_moves() const noexcept
+{
+	if(check_inf_.in_check())
+		return list_noisy_moves();
+	
+	move_generator<board_proxy_t> move_generator{board_proxy_t{*this}};
+	
+	ptl::fixed_capacity_vector<philchess::move,220> moves;
+	
+	const auto pieces=[&](piece_type type0, piece_type type1)
+	{
+		return squares(bitboard::rank_index::from_ranks((piece_bitboard(to_move_,type0) | piece_bitboard(to_move_,type1)).ranks()));
+	};
+	
+	const auto add_move=[&](auto m){ moves.push_back(m); };
+	
+	for(const auto& p: pieces(piece_type::knight,piece_type::knight))
+		move_generator.capture<piece_type::knight>(p,to_move_,add_move);
+	
+	for(const auto& p: pieces(piece_type::rook,piece_type::queen))
+		move_generator.capture<piece_type::rook>(p,to_move_,add_move);
+	
+	for(const auto& p: pieces(piece_type::bishop,piece_type::queen))
+		move_generator.capture<piece_type::bishop>(p,to_move_,add_move);
+	
+	const auto pawns=piece_bitboard(to_move_,piece_type::pawn);
+	move_generator.capture_pawnset(pawns,to_move_,add_move);
+	move_generator.capture_pawnset_enpassant(pawns,to_move_,add_move);
+	
+	static const auto promotion_ranks=bitboard::rank{bitboard::rank_index::from_ranks((std::uint64_t{0b11111111}<<56) | std::uint64_t{0b11111111})};
+	move_generator.non_capture_pawnset_targets(pawns,to_move_,promotion_ranks,add_move);
+	
+	move_generator.capture<piece_type::king>(king_squares_[to_move_],to_move_,add_move);
+	
+	return moves;
+}
+
+ptl::fixed_capacity_vector<philchess::move,220> chessboard::list_pseudo_legal_quiet_moves() const noexcept
+{
+	if(check_inf_.in_check())
+		return list_quiet_moves();
+	
+	move_generator<board_proxy_t> move_generator{board_proxy_t{*this}};
+	
+	ptl::fixed_capacity_vector<philchess::move,220> moves;
+	
+	const auto king_square=king_squares_[to_move_];
+	
+	const auto pieces=[&](piece_type type0, piece_type type1)
+	{
+		return squares(bitboard::rank_index::from_ranks((piece_bitboard(to_move_,type0) | piece_bitboard(to_move_,type1)).ranks()));
+	};
+	
+	const auto add_move=[&](auto m){ moves.push_back(m); };
+	
+	for(const auto& p: pieces(piece_type::knight,piece_type::knight))
+		move_generator.non_capture<piece_type::knight>(p,to_move_,add_move);
+	
+	static const auto non_promotion_ranks = ~bitboard::rank{bitboard::rank_index::from_ranks((std::uint64_t{0b11111111}<<56) | std::uint64_t{0b11111111})};
+	move_generator.non_capture_pawnset_targets(piece_bitboard(to_move_,piece_type::pawn),to_move_,non_promotion_ranks,add_move);
+	
+	for(const auto& p: pieces(piece_type::rook,piece_type::queen))
+		move_generator.non_capture<piece_type::rook>(p,to_move_,add_move);
+	
+	for(const auto& p: pieces(piece_type::bishop,piece_type::queen))
+		move_generator.non_capture<piece_type::bishop>(p,to_move_,add_move);
+	
+	move_generator.king_castle(king_square,to_move_,checked_castle_adder(moves,reverse(to_move_)));
+	move_generator.all_king_without_castle(king_square,to_move_,[&](auto m)
+	{
+		if(piece_type_at(m.to())==piece_type::none)
+			add_move(m);
+	});
+	
+	return moves;
+}
+
+bool chessboard::is_legal(philchess::move m) const noexcept
+{
+	if(check_inf_.in_check()) //not worth the trouble, evasions are cheap to generate and rare anyway
+	{
+		const auto evasions=list_moves();
+		return std::find(std::begin(evasions),std::end(evasions),m)!=std::end(evasions);
+	}
+	
+	const auto from=m.from(), to=m.to();
+	const auto type=piece_type_at(from);
+	if(from==to || type==piece_type::none || owner_at(from)!=to_move_)
+		return false;
+	
+	//the generator marks en passant, but not castling, and only promotions may have the lowest bits set
+	if(m.type()==move_type::castling || (m.type()!=move_type::promotion && (m.value()&0x3)!=0))
+		return false;
+	
+	const auto victim=piece_type_at(to);
+	if(victim!=piece_type::none && owner_at(to)==to_move_)
+		return false;
+	
+	const auto opponent_side=reverse(to_move_);
+	
+	bitboard::rank target;
+	target.set(to);
+	
+	if(m.type()==move_type::en_passant)
+	{
+		if(type!=piece_type::pawn || to.file()!=enpassant_file_ || to.rank()!=(to_move_==side::white?5:2) || (attacked_by_pawn(to_move_,from)&target).ranks()==0)
+			return false;
+		
+		return leaves_king_safe(m);
+	}
+	
+	if(type==piece_type::pawn)
+	{
+		const auto forward=to_move_==side::white?1:-1;
+		if((m.type()==move_type::promotion)!=(to.rank()==(to_move_==side::white?7:0)))
+			return false;
+		
+		if(to.file()==from.file())
+		{
+			if(victim!=piece_type::none)
+				return false;
+			
+			const auto single_push=to.rank()==from.rank()+forward;
+			const auto double_push=
+				to.rank()==from.rank()+2*forward &&
+				from.rank()==(to_move_==side::white?1:6) &&
+				piece_type_at(square{from.file(),from.rank()+forward})==piece_type::none;
+			if(!single_push && !double_push)
+				return false;
+		}
+		else if(victim==piece_type::none || (attacked_by_pawn(to_move_,from)&target).ranks()==0)
+			return false;
+	}
+	else
+	{
+		if(m.type()!=move_type::normal)
+			return false;
+		
+		switch(type)
+		{
+			case piece_type::knight: if((attacked_by_knight(from)&target).ranks()==0) return false; break;
+			case piece_type::bishop: if((attacked_by_bishop(from,occupancy_)&target).ranks()==0) return false; break;
+			case piece_type::rook: if((attacked_by_rook(from,occupancy_)&target).ranks()==0) return false; break;
+			case piece_type::queen: if(((attacked_by_bishop(from,occupancy_)|attacked_by_rook(from,occupancy_))&target).ranks()==0) return false; break;
+			case piece_type::king:
+			{
+				if(std::abs(to.file()-from.file())==2) //castling
+				{
+					ptl::fixed_capacity_vector<philchess::move,2> castles;
+					move_generator<board_proxy_t>{board_proxy_t{*this}}.king_castle(from,to_move_,checked_castle_adder(castles,opponent_side));
+					return std::find(std::begin(castles),std::end(castles),m)!=std::end(castles);
+				}
+				
+				if((attacked_by_king(from)&target).ranks()==0)
+					return false;
+				break;
+			}
+			default: return false;
+		}
+	}
+	
+	return leaves_king_safe(m);
+}
+
+bool chessboard::leaves_king_safe(philchess::move m) const noexcept
+{
+	const auto from=m.from(), to=m.to();
+	const auto king_square=king_squares_[to_move_];
+	const auto opponent_side=reverse(to_move_);
+	
+	if(from==king_square)
+	{
+		if(std::abs(to.file()-from.file())==2) //castling is only ever generated when legal
+			return true;
+		
+		ptl::fixed_capacity_vector<philchess::move,1> evasion;
+		checked_evasion_move_adder(evasion,opponent_side)(m);
+		return !evasion.empty();
+	}
+	
+	//we are not in check, so the only way to end up in one is by moving the last piece out of the way of a slider. en passant takes two off the same rank, though
+	if(m.type()!=move_type::en_passant)
+		return (pin_inf_.blockers[to_move_].ranks()&(std::uint64_t{1}<<from.id()))==0 || aligned(from,to,king_square);
+	
+	auto occupancy_after=occupancy_;
+	occupancy_after.unset(from);
+	occupancy_after.set(to);
+	
+	const square taken{to.file(),from.rank()};
+	bitboard::rank captured;
+	captured.set(taken);
+	occupancy_after.unset(taken);
+	
+	const auto rooks=(piece_bitboard(opponent_side,piece_type::rook)|piece_bitboard(opponent_side,piece_type::queen))&~captured;
+	const auto bishops=(piece_bitboard(opponent_side,piece_type::bishop)|piece_bitboard(opponent_side,piece_type::queen))&~captured;
+	return ((attacked_by_rook(king_square,occupancy_after)&rooks) | (attacked_by_bishop(king_square,occupancy_after)&bishops)).ranks()==0;
+}
+
 void chessboard::set_piece(square sq, piece_type p, side s) noexcept
 {	
 	const auto old_piece=piece_type_at(sq);
@@ -885,6 +1508,19 @@ void chessboard::set_piece(square sq, piece_type p, side s) noexcept
 	
 	zobrist_hash_.update(old_piece, sq, old_piece_owner);
 	zobrist_hash_.update(p, sq, s);
+	
+	if(old_piece==piece_type::pawn)
+		pawn_hash_.update(old_piece, sq, old_piece_owner);
+	if(p==piece_type::pawn)
+		pawn_hash_.update(p, sq, s);
+	
+	material_.remove(old_piece, old_piece_owner);
+	material_.add(p, s);
+	
+	middlegame_pst_[old_piece_owner]-=middlegame_pst_table[old_piece_owner][old_piece][sq];
+	endgame_pst_[old_piece_owner]-=endgame_pst_table[old_piece_owner][old_piece][sq];
+	middlegame_pst_[s]+=middlegame_pst_table[s][p][sq];
+	endgame_pst_[s]+=endgame_pst_table[s][p][sq];
 }
 
 void chessboard::unset_piece(square sq) noexcept
@@ -899,6 +1535,14 @@ void chessboard::unset_piece(square sq) noexcept
 	piece_bitboards_[old_piece].unset(sq);
 	
 	zobrist_hash_.update(old_piece, sq, old_piece_owner);
+	
+	if(old_piece==piece_type::pawn)
+		pawn_hash_.update(old_piece, sq, old_piece_owner);
+	
+	material_.remove(old_piece, old_piece_owner);
+	
+	middlegame_pst_[old_piece_owner]-=middlegame_pst_table[old_piece_owner][old_piece][sq];
+	endgame_pst_[old_piece_owner]-=endgame_pst_table[old_piece_owner][old_piece][sq];
 }
 
 bool chessboard::is_in_check() const noexcept
@@ -922,7 +1566,7 @@ chessboard::check_info_t chessboard::compute_check_info() const noexcept
 	auto king_square=king_squares_[to_move_];
 	const auto opponent_side=reverse(to_move_);
 	
-	const auto last_move=played_moves_.back();
+	const auto last_move=last_ply().move;
 	
 	switch(piece_type_at(last_move.to()))
 	{
@@ -939,117 +1583,93 @@ chessboard::check_info_t chessboard::compute_check_info() const noexcept
 
 bool chessboard::would_check(philchess::move m) const noexcept
 {
-	move_generator<board_proxy_t> move_generator{board_proxy_t{*this}};
+	const auto from=m.from(), to=m.to();
+	const auto opponent_side=reverse(to_move_);
+	const auto opponent_king_square=king_squares_[opponent_side];
 	
-	bool check=false;
-	const auto validate=[&](philchess::move m){ check=true; };
+	//the generator does not mark castling, the king moving two squares is all there is to go by. only the rook can give check then
+	if(const auto info=castling_info(m); info.is_castling && piece_type_at(from)==piece_type::king)
+	{
+		auto occupancy_after=occupancy_;
+		occupancy_after.unset(from);
+		occupancy_after.unset(info.rook_origin);
+		occupancy_after.set(to);
+		occupancy_after.set(info.rook_destination);
+		return (attacked_by_rook(info.rook_destination,occupancy_after).ranks()&(std::uint64_t{1}<<opponent_king_square.id()))!=0;
+	}
 	
-	const auto opponent_side=reverse(to_move_);
-	auto opponent_king_square=king_squares_[opponent_side];
+	bitboard::rank target;
+	target.set(to);
 	
-	if(m.type()==move_type::en_passant)
+	//directly, by the moved piece
+	if((pin_inf_.check_squares[piece_type_at(from)]&target).ranks()!=0)
+		return true;
+	
+	//by whatever it was in the way of
+	if((pin_inf_.blockers[opponent_side].ranks()&(std::uint64_t{1}<<from.id()))!=0 && !aligned(from,to,opponent_king_square))
+		return true;
+	
+	switch(m.type())
 	{
-		move_generator.capture_pawn_without_enpassant_fixed_promotion(m.to(),to_move_,opponent_king_square,validate);
-		
-		if(check)
-			return check;
-			
-		auto occupancy_cpy=occupancy_;
-		occupancy_cpy.unset(m.from());
-		if(m.to().rank()==2)
+		case move_type::promotion:
 		{
-			auto target=square{enpassant_file_, 3};
-			occupancy_cpy.unset(target);
+			auto occupancy_after=occupancy_;
+			occupancy_after.unset(from);
+			return (attacked_by(to_move_,m.promote_to(),opponent_king_square,occupancy_after)&target).ranks()!=0;
 		}
-		else if(m.to().rank()==5)
+		case move_type::en_passant: //the captured pawn might have been in the way, too
 		{
-			auto target=square{enpassant_file_, 4};
-			occupancy_cpy.unset(target);
+			auto occupancy_after=occupancy_;
+			occupancy_after.unset(from);
+			occupancy_after.unset(square{to.file(),from.rank()});
+			occupancy_after.set(to);
+			
+			const auto rooks=piece_bitboard(to_move_,piece_type::rook)|piece_bitboard(to_move_,piece_type::queen);
+			const auto bishops=piece_bitboard(to_move_,piece_type::bishop)|piece_bitboard(to_move_,piece_type::queen);
+			return ((attacked_by_rook(opponent_king_square,occupancy_after)&rooks) | (attacked_by_bishop(opponent_king_square,occupancy_after)&bishops)).ranks()!=0;
 		}
-		
-		auto rook_targets=attacked_by_rook(opponent_king_square,occupancy_cpy).ranks();
-		auto bishop_targets=attacked_by_bishop(opponent_king_square,occupancy_cpy).ranks();
-		
-		const auto rooks_and_queens = piece_bitboard(to_move_,piece_type::rook).ranks() | piece_bitboard(to_move_,piece_type::queen).ranks();
-		const auto bishops_and_queens = piece_bitboard(to_move_,piece_type::bishop).ranks() | piece_bitboard(to_move_,piece_type::queen).ranks();
-		
-		return (rook_targets & rooks_and_queens) || (bishop_targets & bishops_and_queens);
+		default:
+			return false;
 	}
-	else if(m.type()==move_type::castling)
+}
+
+chessboard::pin_info_t chessboard::compute_pin_info() const noexcept
+{
+	pin_info_t ret_val;
+	
+	const auto opponent_side=reverse(to_move_);
+	const auto opponent_king_square=king_squares_[opponent_side];
+	
+	//a pawn attacks the king from where a pawn of the other side standing on the kings square would attack. pawns never get to the edge ranks that would need anything behind the board
+	if(opponent_king_square.rank()!=(to_move_==side::white?0:7))
+		ret_val.check_squares[piece_type::pawn]=attacked_by_pawn(opponent_side,opponent_king_square);
+	ret_val.check_squares[piece_type::knight]=attacked_by_knight(opponent_king_square);
+	ret_val.check_squares[piece_type::bishop]=attacked_by_bishop(opponent_king_square,occupancy_);
+	ret_val.check_squares[piece_type::rook]=attacked_by_rook(opponent_king_square,occupancy_);
+	ret_val.check_squares[piece_type::queen]=ret_val.check_squares[piece_type::bishop] | ret_val.check_squares[piece_type::rook];
+	
+	for(const auto s: {side::white, side::black})
 	{
-		auto castling=castling_info(m);
+		const auto king_square=king_squares_[s];
+		const auto enemy=reverse(s);
 		
-		move_generator.capture<piece_type::rook>(castling.rook_destination,to_move_,opponent_king_square,validate);
+		const auto snipers=
+			(attacked_by_rook(king_square,bitboard::rank{})&(piece_bitboard(enemy,piece_type::rook)|piece_bitboard(enemy,piece_type::queen))) |
+			(attacked_by_bishop(king_square,bitboard::rank{})&(piece_bitboard(enemy,piece_type::bishop)|piece_bitboard(enemy,piece_type::queen)));
 		
-		return check;
-	}
-	else
-	{		
-		switch(piece_type_at(m.from()))
+		for(const auto& sniper: squares(snipers))
 		{
-			case piece_type::pawn: move_generator.capture_pawn_without_enpassant_fixed_promotion(m.to(),to_move_,opponent_king_square,validate); break;
-			case piece_type::knight: move_generator.capture<piece_type::knight>(m.to(),to_move_,opponent_king_square,validate); break;
-			case piece_type::bishop: move_generator.capture<piece_type::bishop>(m.to(),to_move_,opponent_king_square,validate); break;
-			case piece_type::rook: move_generator.capture<piece_type::rook>(m.to(),to_move_,opponent_king_square,validate); break;
-			case piece_type::queen: move_generator.capture<piece_type::queen>(m.to(),to_move_,opponent_king_square,validate); break;
-			case piece_type::king:
-			case piece_type::none: break;
-		}
-		
-		if(check)
-			return check;
-			
-		if(m.type()==move_type::promotion)
-		{	
-			auto occupancy_cpy=occupancy_;
-			occupancy_cpy.unset(m.from());
-			bitboard::rank attacker;
-			attacker.set(m.to());
+			const auto in_between=squares_between(sniper,king_square)&occupancy_;
+			if(ptl::popcount(in_between.ranks())!=1)
+				continue;
 			
-			switch(m.promote_to())
-			{
-				case piece_type::knight: if(attacker.ranks() & attacked_by_knight(opponent_king_square).ranks()) return true; break;
-				case piece_type::bishop: if(attacker.ranks() & attacked_by_bishop(opponent_king_square,occupancy_cpy).ranks()) return true; break;
-				case piece_type::rook: if(attacker.ranks() & attacked_by_rook(opponent_king_square,occupancy_cpy).ranks()) return true; break;
-				case piece_type::queen: if(attacker.ranks() & attacked_by_queen(opponent_king_square,occupancy_cpy).ranks()) return true; break;
-				case piece_type::pawn:
-				case piece_type::king:
-				case piece_type::none: break;
-			}
-		}
-		
-		if(m.from().rank()==opponent_king_square.rank() && m.to().rank()!=m.from().rank())
-		{	
-			const auto rank_rook_attack = attacked_by_rook_on_rank(m.from(),occupancy_);
-			const auto has_attacker = (rank_rook_attack.ranks() & (piece_bitboard(to_move_,piece_type::queen).ranks() | piece_bitboard(to_move_,piece_type::rook).ranks())) > 0;
-			const auto attacks = (rank_rook_attack.ranks() & piece_bitboard(opponent_side,piece_type::king).ranks()) > 0;
-			return has_attacker && attacks;
-		}
-		else if(m.from().file()==opponent_king_square.file() && m.to().file()!=m.from().file())
-		{
-			const auto file_rook_attack = attacked_by_rook_on_file(m.from(),occupancy_);
-			const auto has_attacker = (file_rook_attack.ranks() & (piece_bitboard(to_move_,piece_type::queen).ranks() | piece_bitboard(to_move_,piece_type::rook).ranks())) > 0;
-			const auto attacks = (file_rook_attack.ranks() & piece_bitboard(opponent_side,piece_type::king).ranks()) > 0;
-			return has_attacker && attacks;
+			ret_val.blockers[s]|=in_between;
+			if((in_between&side_occupancy_[s]).ranks()!=0)
+				ret_val.pinners[s].set(sniper);
 		}
-		else if(m.from().diagonal()==opponent_king_square.diagonal() && m.to().diagonal()!=m.from().diagonal())
-		{
-			const auto diagonal_bishop_attack = attacked_by_bishop_on_diagonal(m.from(),occupancy_);
-			const auto has_attacker = (diagonal_bishop_attack.ranks() & (piece_bitboard(to_move_,piece_type::queen).ranks() | piece_bitboard(to_move_,piece_type::bishop).ranks())) > 0;
-			const auto attacks = (diagonal_bishop_attack.ranks() & piece_bitboard(opponent_side,piece_type::king).ranks()) > 0;
-			return has_attacker && attacks;
-		}
-		else if(m.from().antidiagonal()==opponent_king_square.antidiagonal() && m.to().antidiagonal()!=m.from().antidiagonal())
-		{
-			const auto antidiagonal_bishop_attack = attacked_by_bishop_on_antidiagonal(m.from(),occupancy_);
-			const auto has_attacker = (antidiagonal_bishop_attack.ranks() & (piece_bitboard(to_move_,piece_type::queen).ranks() | piece_bitboard(to_move_,piece_type::bishop).ranks())) > 0;
-			const auto attacks = (antidiagonal_bishop_attack.ranks() & piece_bitboard(opponent_side,piece_type::king).ranks()) > 0;
-			return has_attacker && attacks;
-		}
-		
-		return false;
 	}
-
+	
+	return ret_val;
 }
 
 chessboard::check_info_t chessboard::compute_initial_check_info() const noexcept
@@ -1081,25 +1701,45 @@ chessboard::check_info_t chessboard::compute_initial_check_info() const noexcept
 	return ret_val;
 }
 
+bool chessboard::has_game_cycle(unsigned ply) const noexcept
+{
+	//only back to the last irreversible move or null move, anything before cannot be repeated anyway
+	const auto plies_back=std::min<std::size_t>(fifty_move_counter_,plies_);
+	
+	for(std::size_t back=3; back<=plies_back && back<ply; back+=2)
+	{
+		const auto key=zobrist_hash_.value()^history_[(plies_-back)%history_size].hash.value();
+		
+		auto idx=cuckoo_table_t::h1(key);
+		if(cuckoo_table.keys[idx]!=key)
+		{
+			idx=cuckoo_table_t::h2(key);
+			if(cuckoo_table.keys[idx]!=key)
+				continue;
+		}
+		
+		//the table has both directions in one entry, the piece is on one end and the other end is empty, or the hashes would differ by more.
+		//the move also has to be possible right now, nothing in the way, no pin and no check to take care of first
+		const auto m=cuckoo_table.moves[idx];
+		const auto reversed=piece_type_at(m.from())==piece_type::none;
+		if(is_legal(reversed?move{m.to(),m.from()}:m))
+			return true;
+	}
+	
+	return false;
+}
+
 bool chessboard::is_rule_draw() const noexcept
 {
 	if(fifty_move_counter_>=100) //<--names can be deceiving, we count plys(i.e. halfmoves), but 50 move draw happens only after 100 of those, which implies the name i chose sucks and i should change it to reflect what it really counts.
 		return true;
 				 
-	//simplistic repetition detection
-	const auto rounded_movecount=fifty_move_counter_&0xfe;
-	if(rounded_movecount && hashes_.size()>1)
+	//simplistic repetition detection, every second position back to the last irreversible move(or as far as we know, when the fen said it was longer ago)
+	const auto plies_back=std::min<std::size_t>(fifty_move_counter_,plies_)&~std::size_t{1};
+	for(std::size_t back=2; back<=plies_back; back+=2)
 	{
-		const auto start=hashes_.size()-rounded_movecount;
-		const auto end=hashes_.size();
-
-		for(auto idx=start; idx<end; idx+=2)
-		{
-			if(hashes_[idx]==zobrist_hash_)
-			{
-				return true;
-			}
-		}
+		if(history_[(plies_-back)%history_size].hash==zobrist_hash_)
+			return true;
 	}
 	
 	return false;
@@ -1,12 +1,15 @@
 #include <philchess/default_search_control.hpp>
 
 #include <philchess/eval/default_evaluation.hpp>
-#include <philchess/eval/king_safety.hpp>
-#include <philchess/eval/mobility.hpp>
-#include <philchess/eval/phase.hpp>
+#include <philchess/eval/nnue.hpp>
 #include <philchess/eval/piece_square_table.hpp>
 #include <philchess/eval/see.hpp>
 
+#include <algorithm>
+#include <limits>
+
+#include <cstdlib>
+
 
 using namespace philchess;
 
@@ -48,7 +51,11 @@ int default_search_control::quiescent_search(chessboard& board, algorithm::alpha
 	if(!in_check && decision_fun(stand_pat)==algorithm::search_decision::cutoff)
 		return decision_fun.get_score();
 	
+#if defined(PHILCHESS_LEGAL_MOVE_GENERATION)
 	auto movelist=board.list_noisy_moves();
+#else
+	auto movelist=board.list_pseudo_legal_noisy_moves(); //legal anyway when in check
+#endif
 	
 	if(movelist.empty() && in_check)
 	{
@@ -97,6 +104,10 @@ int default_search_control::quiescent_search(chessboard& board, algorithm::alpha
 	{
 		if(!in_check && !philchess::eval::see_gain(board,move))
 			continue;
+#if !defined(PHILCHESS_LEGAL_MOVE_GENERATION)
+		if(!in_check && !board.leaves_king_safe(move))
+			continue;
+#endif
 				
 		auto undo_data=board.do_move(move);
 			auto score=-quiescent_search(board, decision_fun.get_reversed(),depth+1);
@@ -117,58 +128,19 @@ int default_search_control::quiescent_search(chessboard& board, algorithm::alpha
 int default_search_control::static_eval(const chessboard& board) const noexcept
 {
 	++evaluated_node_num_;
-		
-	const static auto castling_eval_tmp=[]()
-	{
-		castling_right_map<int> ret_val;
-		ret_val[castling_right::none]=0;
-		ret_val[castling_right::kingside]=2;
-		ret_val[castling_right::queenside]=1;	
-		ret_val[castling_right::both]=3;
-		return ret_val;
-	}();
-	
-	struct factor_pair_t
-	{
-		int middlegame, endgame;
-	};
-		
-	const static struct evaluation_parameters_t
+	
+	const auto cached=eval_cache_.probe(board.zobrist_hash_);
+	if(cached)
 	{
-		evaluation_parameters_t():
-			piece_square_tables{eval::get_default_piece_square_table()},
-			endgame_piece_square_tables{eval::get_endgame_piece_square_table()},
-			castling_eval{castling_eval_tmp}
-		{};
-		
-		const std::decay_t<decltype(eval::get_default_piece_square_table())>& piece_square_tables;
-		const std::decay_t<decltype(eval::get_endgame_piece_square_table())>& endgame_piece_square_tables;
-		
-		const std::decay_t<decltype(eval::get_mobility_eval_tables())>& mobility_eval_tables{eval::get_mobility_eval_tables()};
-		
-		const castling_right_map<int> castling_eval;
-		
-		const factor_pair_t isolated_pawn_penalty{19,-3};
-		const factor_pair_t backwards_pawn_penalty{-7,-10};
-		const factor_pair_t doubled_pawn_penalty{-77,-30};
-		const factor_pair_t passed_pawn_bonus{99,45};
-		const factor_pair_t connected_pawn_bonus{11,12};
-		const factor_pair_t occupied_hole_bonus{2,18};
-		const factor_pair_t rook_on_open_file_bonus{-54,-6};
-		const factor_pair_t controlled_square_bonus{-8,-2};
-		const factor_pair_t hanging_piece_penalty{60,22};
-		
-		const eval::material_factors<int>& castling_rights_factor{eval::get_castling_rights_table()};
-		const eval::material_factors<int>& kingsquare_attacker_factor{eval::get_kingsquare_attacker_table()};
-		const eval::material_factors<int>& primary_pawnshield_bonus{eval::get_primary_pawnshield_table()};
-		const eval::material_factors<int>& secondary_pawnshield_bonus{eval::get_secondary_pawnshield_table()};
-		const eval::material_factors<int>& number_of_open_files_in_king_vicinity_penalty{eval::get_open_files_table()};
-		
-		const eval::material_factors<int>& phase_factors{eval::get_phase_factor_table()};
-		
-	} parameters;
+		++saved_evaluations_;
+		return *cached;
+	}
 	
-	return eval::default_evaluation<int>(board,parameters);
+	const auto ret_val=network_?
+		eval::nnue::evaluate(*network_,board.accumulator(),board.to_move_):
+		eval::default_evaluation<int>(board,eval_parameters_,pawn_cache_);
+	eval_cache_.store(board.zobrist_hash_,ret_val);
+	return ret_val;
 }
 
 int default_search_control::mate_eval(const chessboard& board, unsigned depth) const noexcept
@@ -222,22 +194,70 @@ bool default_search_control::is_insufficient_material(const chessboard& board) n
 	return false;
 }
 
+/*
+	The transposition table only has 16 bits per score, which is plenty for anything the evaluation produces,
+	but not for the mate scores around 200000 and certainly not for the infinities of the search window.
+	So:
+	  - infinities are kept as +-32767,
+	  - mates as +-(32000-distance), so the distance survives,
+	  - and everything else is simply clamped to +-30000, which no sane evaluation ever reaches anyway.
+*/
+namespace
+{
+	constexpr int tt_infinity=32767, tt_mate=32000, tt_max_eval=30000;
+}
+
+std::int16_t default_search_control::to_tt_score(int score) noexcept
+{
+	if(::std::abs(score)>=::std::numeric_limits<int>::max())
+		return score<0?-tt_infinity:tt_infinity;
+	
+	const auto dist=mate_distance(score);
+	if(dist)
+	{
+		const auto abs_dist=::std::min(::std::abs(*dist),tt_mate-tt_max_eval-1);
+		return score<0?-(tt_mate-abs_dist):tt_mate-abs_dist;
+	}
+	
+	return ::std::clamp(score,-tt_max_eval,tt_max_eval);
+}
+
+int default_search_control::from_tt_score(std::int16_t score) noexcept
+{
+	const int abs_score=::std::abs(score);
+	if(abs_score==tt_infinity)
+		return score<0?-::std::numeric_limits<int>::max() : ::std::numeric_limits<int>::max();
+	
+	if(abs_score>tt_max_eval)
+	{
+		const auto dist=tt_mate-abs_score;
+		return score<0?-(max_mate_score-dist):max_mate_score-dist;
+	}
+	
+	return score;
+}
+
 void default_search_control::cache_eval(const chessboard& board, int eval, score_type type, move m, std::uint8_t depth) noexcept
 {
-	const auto zobrist_hash=board.zobrist_hash_;
-	const auto idx=(zobrist_hash.value()>>(64-cache_hash_bitsize_));
-	cache_[idx]={zobrist_hash,eval,m,type,depth};
+	tt_->store(board.zobrist_hash_,to_tt_score(eval),type,m,depth);
 }
 
 std::optional<default_search_control::eval_t> default_search_control::cached_eval(const chessboard& board, std::uint8_t min_depth) const noexcept
 {
-	const auto zobrist_hash=board.zobrist_hash_;
-	const auto idx=(zobrist_hash.value()>>(64-cache_hash_bitsize_));
-	const auto& entry=cache_[idx];
-	if(entry.depth>=min_depth && entry.zobrist_hash==zobrist_hash)
+	++cache_probes_;
+	
+	const auto entry=tt_->probe(board.zobrist_hash_,min_depth);
+	
+	//With only 16 bits of the key stored, the occasional false hit is to be expected. A move that does not even start on one of our pieces gives those away cheaply.
+	//Whether it is really legal is only checked where the move gets used, is_legal on every probe is not worth it for the scores alone.
+	if(entry && entry->best_or_refutation_move!=move{} && 
+		(board.piece_type_at(entry->best_or_refutation_move.from())==piece_type::none || board.owner_at(entry->best_or_refutation_move.from())!=board.side_to_move()))
+		return std::nullopt;
+	
+	if(entry)
 	{
 		++cache_hits_;
-		return std::optional<default_search_control::eval_t>{{ entry.eval, entry.type, entry.best_or_refutation_move }};
+		return std::optional<default_search_control::eval_t>{{ from_tt_score(entry->eval), entry->type, entry->best_or_refutation_move }};
 	}
 
 	return std::nullopt;
@@ -3,7 +3,9 @@
 
 #include <philchess/chessboard.hpp>
 #include <philchess/default_search_control.hpp>
+#include <philchess/perft.hpp>
 #include <philchess/time_manager.hpp>
+#include <philchess/transposition_table.hpp>
 #include <philchess/types.hpp>
 
 #include <philchess/algorithm/alpha_beta_pruning.hpp>
@@ -11,14 +13,22 @@
 #include <philchess/algorithm/iterative_deepening.hpp>
 #include <philchess/algorithm/negamax.hpp>
 
+#include <philchess/eval/nnue.hpp>
+
 #include <philchess/uci/types.hpp>
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <memory>
 #include <optional>
+#include <string>
 #include <string_view>
+#include <thread>
 #include <variant>
+#include <vector>
 
 namespace philchess {
 namespace engine
@@ -30,13 +40,18 @@ namespace engine
 		public:
 		constexpr static auto name="paulchen332 v0.1.1"sv;
 		constexpr static auto authors="Philipp Lenk"sv;
-		inline const static std::array<uci::option_description,1> option_list
+		inline const static std::array<uci::option_description,5> option_list
 		{{
-			{"Hash"sv,uci::option_value<uci::option_type::spin>{32,0,4096}}
+			{"Hash"sv,uci::option_value<uci::option_type::spin>{32,0,4096}},
+			{"Threads"sv,uci::option_value<uci::option_type::spin>{1,1,128}},
+			{"LargePages"sv,uci::option_value<uci::option_type::check>{false}},
+			{"EvalFile"sv,uci::option_value<uci::option_type::string>{""}},
+			{"UseNNUE"sv,uci::option_value<uci::option_type::check>{false}}
 		}};
 		
 		explicit paulchen332(const philchess::search_parameters& params):
-			search_control{params}
+			parameters_{params},
+			search_control{params,tt_}
 		{}
 		
 		paulchen332():
@@ -48,6 +63,33 @@ namespace engine
 			search_control.resize_tt(hashsize_mb);
 		}
 		
+		void set_option(std::integral_constant<std::size_t,1>, int number_of_threads)
+		{
+			helpers_.clear();
+			for(int i=1;i<number_of_threads;++i)
+				helpers_.push_back(std::make_unique<default_search_control>(parameters_,tt_));
+			select_evaluation();
+		}
+		
+		void set_option(std::integral_constant<std::size_t,2>, bool use_large_pages)
+		{
+			tt_->use_large_pages(use_large_pages);
+		}
+		
+		//a HalfKP net, as in the first Stockfish NNUE versions(see eval/nnue.hpp)
+		void set_option(std::integral_constant<std::size_t,3>, const std::string& path)
+		{
+			eval_file_=path;
+			network_=eval::nnue::load_network(path);
+			select_evaluation();
+		}
+		
+		void set_option(std::integral_constant<std::size_t,4>, bool use_nnue)
+		{
+			use_nnue_=use_nnue;
+			select_evaluation();
+		}
+		
 		void reset()
 		{
 			board.setup("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
@@ -89,12 +131,63 @@ namespace engine
 				time_mgr.emplace(time_settings, to_move);
 			}
 			
+			if(use_nnue_ && !network_)
+				controller.io.debug_message("UseNNUE is set, but no network could be loaded from '",eval_file_,"', using the handcrafted evaluation");
+			
+			tt_->new_search();
+			board.set_prefetch_hook([](const void* tt, zobrist hash) noexcept
+			{
+				static_cast<const transposition_table*>(tt)->prefetch(hash);
+			},tt_.get());
+			
+			//Lazy SMP: The helpers simply search the same position with their own board and search control, only sharing the transposition table.
+			//Every other one starts a ply deeper, so that they do not all walk through the same depths in lockstep. Their results are never used
+			//directly, they only ever help by filling the table for the main search. 
+			//Their stats are only ever written by themselves while they search, so they are reset here, before they start, and only read as differences to what was reported already.
+			for(auto& helper:helpers_)
+				helper->reset_stats();
+			std::vector<unsigned> helper_nodes_reported(helpers_.size(),0);
+			
+			std::atomic<bool> helpers_should_stop{false};
+			std::vector<std::thread> helper_threads;
+			for(std::size_t id=0;id<helpers_.size();++id)
+			{
+				helper_threads.emplace_back([&control=*helpers_[id], helper_board=board, id, max_depth, &helpers_should_stop]()
+				{
+					for(unsigned depth=1+id%2;depth<=max_depth+1 && !helpers_should_stop;++depth)
+					{
+						const auto result=philchess::algorithm::negamax(helper_board,control,philchess::algorithm::alpha_beta_pruning<score_t>{},[&helpers_should_stop](){ return helpers_should_stop.load(); },depth);
+						if(!result)
+							break;
+					}
+				});
+			}
+			
+			const auto number_of_nodes = [this, &helper_nodes_reported]()
+			{
+				auto ret_val=search_control.number_of_statically_evaluated_nodes();
+				for(std::size_t id=0;id<helpers_.size();++id)
+				{
+					const auto nodes=helpers_[id]->number_of_statically_evaluated_nodes();
+					ret_val+=nodes-helper_nodes_reported[id];
+					helper_nodes_reported[id]=nodes;
+				}
+				return ret_val;
+			};
+			
+			//"go nodes": the main search stops once it has searched that many, counting the completed depths and the one it is in. The helpers' nodes are only added after every depth, so with more threads it overshoots a bit
+			std::uint64_t nodes_of_completed_depths=0;
+			const auto node_limit_reached = [this, &nodes_of_completed_depths, limit=settings.nodes]()
+			{
+				return limit && nodes_of_completed_depths+search_control.number_of_statically_evaluated_nodes()>=*limit;
+			};
+			
 			const auto init_deepening = [this]()
 			{
 				return *philchess::algorithm::negamax(board,search_control,philchess::algorithm::alpha_beta_pruning<score_t>{},[](){ return false; }, 1); //<-- safe to dereference, as it cannot be aborted...
 			};
 			
-			const auto search_depth = [this,controller,&time_mgr](const auto& last_result, unsigned desired_depth) mutable
+			const auto search_depth = [this,controller,&time_mgr,&node_limit_reached](const auto& last_result, unsigned desired_depth) mutable
 			{
 				controller.io.debug_message("lastEval ",last_result.eval," min ",last_result.eval-30," max ",last_result.eval+30);
 
@@ -103,16 +196,16 @@ namespace engine
 
 				
 				auto result=philchess::algorithm::aspiration_window_search(wnd,
-					[this,desired_depth, controller, &time_mgr](auto decision_fun)
+					[this,desired_depth, controller, &time_mgr, &node_limit_reached](auto decision_fun)
 					{
 						return philchess::algorithm::negamax(board,search_control, decision_fun,
-							[controller,&time_mgr]()
+							[controller,&time_mgr,&node_limit_reached]()
 							{
-								return controller.should_stop || (time_mgr && time_mgr->time_is_elapsed());
+								return controller.should_stop || (time_mgr && time_mgr->time_is_elapsed()) || node_limit_reached();
 							},
 							desired_depth);
 					},
-					[controller, &time_mgr](auto failure_type, auto eval) mutable
+					[controller, &time_mgr, &node_limit_reached](auto failure_type, auto eval) mutable
 					{
 						controller.io.debug_message("eval ",eval," failed ", failure_type==philchess::algorithm::aspiration_search_result::fail_low?"low":"high");
 						
@@ -120,21 +213,25 @@ namespace engine
 						if(time_mgr && (failure_type==philchess::algorithm::aspiration_search_result::fail_low || eval<300)) //the <300 is arbitrary so, but intends to be a score that is pretty certain to be a win already
 							time_mgr->try_extend();
 						
-						return controller.should_stop || (time_mgr && time_mgr->time_is_elapsed());
+						return controller.should_stop || (time_mgr && time_mgr->time_is_elapsed()) || node_limit_reached();
 					}
 				);
 				return result;
 			};
 			
-			const auto on_completed_depth = [this, controller, start_time, &time_mgr, max_depth](const auto& last_result, auto depth) mutable
+			const auto on_completed_depth = [this, controller, start_time, &time_mgr, max_depth, &number_of_nodes, &nodes_of_completed_depths, &node_limit_reached](const auto& last_result, auto depth) mutable
 			{
 				const auto now=std::chrono::high_resolution_clock::now();
 				const std::chrono::milliseconds elapsed=std::chrono::duration_cast<std::chrono::milliseconds>(now-start_time);
 				
+				const auto depth_nodes=number_of_nodes();
+				nodes_of_completed_depths+=depth_nodes;
+				
 				controller.io.report_pv(
 					{depth,search_control.max_quiescent_depth()},
 					elapsed,
-					search_control.number_of_statically_evaluated_nodes(),
+					depth_nodes,
+					search_control.hashfull(),
 					last_result.eval,
 					search_control.mate_distance(last_result.eval),
 					last_result.pv
@@ -143,9 +240,11 @@ namespace engine
 				controller.io.debug_message("number of cache hits: ",search_control.number_of_cache_hits());
 				controller.io.debug_message("number of quiescent nodes: ",search_control.number_of_quiescent_nodes());
 				controller.io.debug_message("number of travsered nodes: ",search_control.number_of_traversed_nodes());
+				controller.io.debug_message("evaluations saved by the eval cache: ",search_control.number_of_saved_evaluations());
+				controller.io.debug_message("pawn hash hits: ",search_control.number_of_pawn_cache_hits()," of ",search_control.number_of_pawn_cache_probes());
 				search_control.reset_stats();
 				
-				return controller.should_stop || (time_mgr && !time_mgr->should_attemt_new_depth()) || depth>max_depth;
+				return controller.should_stop || (time_mgr && !time_mgr->should_attemt_new_depth()) || depth>max_depth || node_limit_reached();
 			};
 			
 			auto result= philchess::algorithm::iterative_deepening(
@@ -154,12 +253,41 @@ namespace engine
 				on_completed_depth
 			);
 			
+			helpers_should_stop=true;
+			for(auto& thd:helper_threads)
+				thd.join();
+			
 			return result.pv[0];
 		}
 		
+		auto perft(uci::perft_settings settings) const
+		{
+			//no hashing here, perft is mostly used to check the move generator and hash collisions would be one more thing to worry about
+			return philchess::perft(board,settings.depth,{static_cast<unsigned>(helpers_.size()+1),0});
+		}
+		
 		private:
+		void select_evaluation()
+		{
+			const auto net=use_nnue_?network_:nullptr;
+			//scores and bounds from the other evaluation would be taken as they are and only slowly pushed out, so start over with an empty table if it changes
+			if(net.get()!=board.network())
+				search_control.reset_tt();
+			board.set_network(net.get());
+			search_control.use_network(net);
+			for(auto& helper:helpers_)
+				helper->use_network(net);
+		}
+		
 		chessboard board;
+		philchess::search_parameters parameters_;
+		std::shared_ptr<transposition_table> tt_=std::make_shared<transposition_table>();
 		default_search_control search_control;
+		std::vector<std::unique_ptr<default_search_control>> helpers_;
+		
+		std::string eval_file_;
+		std::shared_ptr<const eval::nnue::network> network_;
+		bool use_nnue_=false;
 	};
 
 }} //end namespace philchess:engine
@@ -0,0 +1,52 @@
+#ifndef PHILCHESS_ENGINE_SILENT_CONTROLLER_H
+#define PHILCHESS_ENGINE_SILENT_CONTROLLER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace philchess {
+namespace engine
+{
+	/*
+		A controller for paulchen332::search, for the tests and tools that drive the engine directly instead of over uci. It prints nothing, only remembers
+		the score of the last completed depth, which is the one the move comes from, and adds up the nodes of all of them, so one report can collect several searches.
+	*/
+	struct search_report
+	{
+		int score=0;
+		std::optional<int> mate_distance;
+		std::uint64_t nodes=0;
+	};
+
+	struct silent_io
+	{
+		struct depth_info
+		{
+			unsigned depth, selective_depth;
+		};
+
+		search_report* report;
+
+		template <typename... T>
+		void debug_message(const T&...) {}
+
+		template <typename SCORE_T, typename PV_T>
+		void report_pv(depth_info, std::chrono::milliseconds, unsigned nodes, std::optional<unsigned>, SCORE_T score, std::optional<SCORE_T> mate_distance, const PV_T&)
+		{
+			report->score=score;
+			report->mate_distance=mate_distance;
+			report->nodes+=nodes;
+		}
+	};
+
+	struct silent_controller
+	{
+		const std::atomic<bool>& should_stop;
+		silent_io io;
+	};
+
+}} //end namespace philchess::engine
+
+#endif
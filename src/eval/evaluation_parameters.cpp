@@ -0,0 +1,48 @@
+#include <philchess/eval/evaluation_parameters.hpp>
+#include <philchess/eval/king_safety.hpp>
+#include <philchess/eval/phase.hpp>
+
+using namespace philchess;
+
+namespace
+{
+	auto init_evaluation_parameters() noexcept
+	{
+		eval::evaluation_parameters ret_val{};
+		ret_val.mobility_eval_tables=eval::get_mobility_eval_tables();
+
+		ret_val.castling_eval[castling_right::none]=0;
+		ret_val.castling_eval[castling_right::kingside]=2;
+		ret_val.castling_eval[castling_right::queenside]=1;
+		ret_val.castling_eval[castling_right::both]=3;
+
+		ret_val.isolated_pawn_penalty={19,-3};
+		ret_val.backwards_pawn_penalty={-7,-10};
+		ret_val.doubled_pawn_penalty={-77,-30};
+		ret_val.passed_pawn_bonus={99,45};
+		ret_val.connected_pawn_bonus={11,12};
+		ret_val.occupied_hole_bonus={2,18};
+		ret_val.rook_on_open_file_bonus={-54,-6};
+		ret_val.controlled_square_bonus={-8,-2};
+		ret_val.hanging_piece_penalty={60,22};
+
+		ret_val.castling_rights_factor=eval::get_castling_rights_table();
+		ret_val.kingsquare_attacker_factor=eval::get_kingsquare_attacker_table();
+		ret_val.primary_pawnshield_bonus=eval::get_primary_pawnshield_table();
+		ret_val.secondary_pawnshield_bonus=eval::get_secondary_pawnshield_table();
+		ret_val.number_of_open_files_in_king_vicinity_penalty=eval::get_open_files_table();
+
+		ret_val.phase_factors=eval::get_phase_factor_table();
+
+		ret_val.middlegame_pst=eval::get_default_piece_square_table();
+		ret_val.endgame_pst=eval::get_endgame_piece_square_table();
+
+		return ret_val;
+	}
+}
+
+const eval::evaluation_parameters& eval::get_default_evaluation_parameters() noexcept
+{
+	const static auto ret_val=init_evaluation_parameters();
+	return ret_val;
+}
@@ -3,7 +3,7 @@
 using namespace philchess;
 
 namespace
-{			
+{
 	constexpr auto init_castling_rights_table() noexcept
 	{
 		eval::material_factors<int> ret_val{};
@@ -125,7 +125,7 @@ namespace
 
 		return ret_val;
 	}
-		
+	
 	constexpr auto init_primary_pawnshield_table() noexcept
 	{
 		eval::material_factors<int> ret_val{};
@@ -186,7 +186,7 @@ namespace
 
 		return ret_val;
 	}
-		
+	
 	constexpr auto init_secondary_pawnshield_table() noexcept
 	{
 		eval::material_factors<int> ret_val{};
@@ -307,7 +307,7 @@ namespace
 		ret_val[eval::compute_material_factor_key({2,2,2,1})]=-28;
 
 		return ret_val;
-	}	
+	}
 }
 
 const eval::material_factors<int>& eval::get_castling_rights_table() noexcept
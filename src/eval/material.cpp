@@ -0,0 +1,75 @@
+#include <philchess/eval/material.hpp>
+
+using namespace philchess;
+
+namespace
+{
+	auto init_material_info_table()
+	{
+		std::vector<eval::material_info> ret_val(material_signature::number_of_clipped_indices);
+		
+		//every clipped count is reached by some real signature, so simply enumerate them all and let the signature tell where they belong
+		for(unsigned index=0;index<material_signature::number_of_clipped_indices;++index)
+		{
+			material_signature material;
+			side_map<piece_type_map<unsigned>> counts{};
+			
+			auto rest=index;
+			for(const auto s: {side::white, side::black})
+			{
+				const auto add=[&](piece_type t, unsigned number_of_values)
+				{
+					counts[s][t]=rest%number_of_values;
+					rest/=number_of_values;
+					for(unsigned i=0;i<counts[s][t];++i)
+						material.add(t,s);
+				};
+				add(piece_type::pawn,2);
+				add(piece_type::knight,4);
+				add(piece_type::bishop,4);
+				add(piece_type::rook,3);
+				add(piece_type::queen,2);
+			}
+			
+			piece_type_map<unsigned> total_counts{};
+			for(const auto t: {piece_type::bishop, piece_type::knight, piece_type::rook, piece_type::queen})
+				total_counts[t]=counts[side::white][t]+counts[side::black][t];
+			
+			auto& info=ret_val[material.clipped_index()];
+			info.likely_drawn=eval::is_likely_drawn(counts);
+			info.keys[side::white]=eval::extract_and_compute_material_factor_key(counts[side::white]);
+			info.keys[side::black]=eval::extract_and_compute_material_factor_key(counts[side::black]);
+			info.total_key=eval::extract_and_compute_material_factor_key(total_counts);
+		}
+		
+		return ret_val;
+	}
+}
+
+bool eval::is_likely_drawn(const side_map<piece_type_map<unsigned>>& counts) noexcept
+{
+	if
+	(
+		counts[side::white][piece_type::pawn]==0 && counts[side::black][piece_type::pawn]==0 &&
+		counts[side::white][piece_type::queen]==0 && counts[side::black][piece_type::queen]==0
+	)
+	{
+		const auto black_minor = counts[side::black][piece_type::bishop]+counts[side::black][piece_type::knight];
+		const auto white_minor = counts[side::white][piece_type::bishop]+counts[side::white][piece_type::knight];
+			
+		if
+		(
+			(counts[side::white][piece_type::rook]==1 && counts[side::black][piece_type::rook]==0 && white_minor==0 && black_minor<3 && black_minor>0) ||
+			(counts[side::black][piece_type::rook]==1 && counts[side::white][piece_type::rook]==0 && black_minor==0 && white_minor<3 && white_minor>0)
+		)
+			return true;
+	}
+	
+	return false;
+}
+
+const std::vector<eval::material_info>& eval::get_material_info_table()
+{
+	const static auto table=init_material_info_table();
+	return table;
+}
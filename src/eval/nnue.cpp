@@ -0,0 +1,269 @@
+#include <philchess/eval/nnue.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+#if !defined(PHILCHESS_NNUE_SCALAR) && (defined(__AVX2__) || defined(__SSSE3__))
+#include <immintrin.h>
+#endif
+
+using namespace philchess;
+using namespace philchess::eval::nnue;
+
+namespace
+{
+	/*
+		The file is simply everything in order, little endian: a header with version, a hash and a description, then the feature transformer
+		and the rest of the network, each with one more hash in front. The hashes describe the architecture, so they are the same in every such file.
+		The one in the header is the other two xored.
+	*/
+	constexpr std::uint32_t file_version=0x7AF32F16;
+	constexpr std::uint32_t network_hash=0x3E5AA6EE;
+	constexpr std::uint32_t hidden_layers_hash=0x63337156;
+	constexpr std::uint32_t feature_transformer_hash=network_hash^hidden_layers_hash;
+
+	static_assert(sizeof(half_accumulator)==half_dimensions*sizeof(std::int16_t),"the feature weights are read and written in one go, so the rows must not be padded");
+	
+	constexpr int weight_scale_bits=6; //the hidden layers weights are scaled by 64
+	constexpr int output_scale=16;
+	constexpr int pawn_value=208; //in the units the nets were trained with
+
+	template <typename T>
+	bool read(std::istream& in, T* values, std::size_t count)
+	{
+		return static_cast<bool>(in.read(reinterpret_cast<char*>(values),static_cast<std::streamsize>(sizeof(T)*count)));
+	}
+
+	template <typename T>
+	bool write(std::ostream& out, const T* values, std::size_t count)
+	{
+		return static_cast<bool>(out.write(reinterpret_cast<const char*>(values),static_cast<std::streamsize>(sizeof(T)*count)));
+	}
+
+	//both halves, side to move first, clipped to 0..127
+	using transformed_t=std::array<std::uint8_t,2*half_dimensions>;
+	using hidden_t=std::array<std::uint8_t,hidden_dimensions>;
+
+	hidden_t clipped_relu(const std::array<std::int32_t,hidden_dimensions>& sums) noexcept
+	{
+		hidden_t ret_val;
+		for(std::size_t i=0;i<hidden_dimensions;++i)
+			ret_val[i]=static_cast<std::uint8_t>(std::clamp(sums[i]>>weight_scale_bits,0,127));
+		return ret_val;
+	}
+
+#if !defined(PHILCHESS_NNUE_SCALAR) && defined(__AVX2__)
+	constexpr std::size_t lanes=16; //16 bit values per register
+
+	inline __m256i load(const void* ptr) noexcept { return _mm256_load_si256(static_cast<const __m256i*>(ptr)); }
+
+	void add_rows(const network& net, const half_accumulator& before, half_accumulator& after, const feature_list& added, const feature_list& removed) noexcept
+	{
+		for(std::size_t i=0;i<half_dimensions;i+=lanes)
+		{
+			auto sum=load(&before.values[i]);
+			for(const auto feature: removed)
+				sum=_mm256_sub_epi16(sum,load(&net.feature_weights[feature].values[i]));
+			for(const auto feature: added)
+				sum=_mm256_add_epi16(sum,load(&net.feature_weights[feature].values[i]));
+			_mm256_store_si256(reinterpret_cast<__m256i*>(&after.values[i]),sum);
+		}
+	}
+
+	void transform(const accumulator& acc, side to_move, transformed_t& out) noexcept
+	{
+		const auto zero=_mm256_setzero_si256();
+		std::size_t offset=0;
+		for(const auto s: {to_move,reverse(to_move)})
+		{
+			for(std::size_t i=0;i<half_dimensions;i+=2*lanes)
+			{
+				//negative values are cut off first, the saturation while packing takes care of the upper end. the packing interleaves the 128 bit halves, the permutation sorts them again
+				const auto lower=_mm256_max_epi16(load(&acc.halves[s].values[i]),zero);
+				const auto upper=_mm256_max_epi16(load(&acc.halves[s].values[i+lanes]),zero);
+				_mm256_store_si256(reinterpret_cast<__m256i*>(&out[offset+i]),_mm256_permute4x64_epi64(_mm256_packs_epi16(lower,upper),0xD8));
+			}
+			offset+=half_dimensions;
+		}
+	}
+
+	//the inputs are at most 127, so two products never saturate the 16 bit sums of maddubs
+	template <std::size_t input_size>
+	std::int32_t dot(const std::uint8_t* input, const std::int8_t* weights) noexcept
+	{
+		const auto ones=_mm256_set1_epi16(1);
+		auto sum=_mm256_setzero_si256();
+		for(std::size_t i=0;i<input_size;i+=32)
+		{
+			const auto products=_mm256_maddubs_epi16(load(input+i),load(weights+i));
+			sum=_mm256_add_epi32(sum,_mm256_madd_epi16(products,ones));
+		}
+		auto sum128=_mm_add_epi32(_mm256_castsi256_si128(sum),_mm256_extracti128_si256(sum,1));
+		sum128=_mm_add_epi32(sum128,_mm_shuffle_epi32(sum128,0x4E));
+		sum128=_mm_add_epi32(sum128,_mm_shuffle_epi32(sum128,0xB1));
+		return _mm_cvtsi128_si32(sum128);
+	}
+#elif !defined(PHILCHESS_NNUE_SCALAR) && defined(__SSSE3__)
+	constexpr std::size_t lanes=8;
+
+	inline __m128i load(const void* ptr) noexcept { return _mm_load_si128(static_cast<const __m128i*>(ptr)); }
+
+	void add_rows(const network& net, const half_accumulator& before, half_accumulator& after, const feature_list& added, const feature_list& removed) noexcept
+	{
+		for(std::size_t i=0;i<half_dimensions;i+=lanes)
+		{
+			auto sum=load(&before.values[i]);
+			for(const auto feature: removed)
+				sum=_mm_sub_epi16(sum,load(&net.feature_weights[feature].values[i]));
+			for(const auto feature: added)
+				sum=_mm_add_epi16(sum,load(&net.feature_weights[feature].values[i]));
+			_mm_store_si128(reinterpret_cast<__m128i*>(&after.values[i]),sum);
+		}
+	}
+
+	void transform(const accumulator& acc, side to_move, transformed_t& out) noexcept
+	{
+		const auto zero=_mm_setzero_si128();
+		std::size_t offset=0;
+		for(const auto s: {to_move,reverse(to_move)})
+		{
+			for(std::size_t i=0;i<half_dimensions;i+=2*lanes)
+			{
+				const auto lower=_mm_max_epi16(load(&acc.halves[s].values[i]),zero);
+				const auto upper=_mm_max_epi16(load(&acc.halves[s].values[i+lanes]),zero);
+				_mm_store_si128(reinterpret_cast<__m128i*>(&out[offset+i]),_mm_packs_epi16(lower,upper));
+			}
+			offset+=half_dimensions;
+		}
+	}
+
+	template <std::size_t input_size>
+	std::int32_t dot(const std::uint8_t* input, const std::int8_t* weights) noexcept
+	{
+		const auto ones=_mm_set1_epi16(1);
+		auto sum=_mm_setzero_si128();
+		for(std::size_t i=0;i<input_size;i+=16)
+		{
+			const auto products=_mm_maddubs_epi16(load(input+i),load(weights+i));
+			sum=_mm_add_epi32(sum,_mm_madd_epi16(products,ones));
+		}
+		sum=_mm_add_epi32(sum,_mm_shuffle_epi32(sum,0x4E));
+		sum=_mm_add_epi32(sum,_mm_shuffle_epi32(sum,0xB1));
+		return _mm_cvtsi128_si32(sum);
+	}
+#else
+	void add_rows(const network& net, const half_accumulator& before, half_accumulator& after, const feature_list& added, const feature_list& removed) noexcept
+	{
+		after=before;
+		for(const auto feature: removed)
+		{
+			for(std::size_t i=0;i<half_dimensions;++i)
+				after.values[i]-=net.feature_weights[feature].values[i];
+		}
+		for(const auto feature: added)
+		{
+			for(std::size_t i=0;i<half_dimensions;++i)
+				after.values[i]+=net.feature_weights[feature].values[i];
+		}
+	}
+
+	void transform(const accumulator& acc, side to_move, transformed_t& out) noexcept
+	{
+		std::size_t offset=0;
+		for(const auto s: {to_move,reverse(to_move)})
+		{
+			for(std::size_t i=0;i<half_dimensions;++i)
+				out[offset+i]=static_cast<std::uint8_t>(std::clamp<int>(acc.halves[s].values[i],0,127));
+			offset+=half_dimensions;
+		}
+	}
+
+	template <std::size_t input_size>
+	std::int32_t dot(const std::uint8_t* input, const std::int8_t* weights) noexcept
+	{
+		std::int32_t sum=0;
+		for(std::size_t i=0;i<input_size;++i)
+			sum+=input[i]*weights[i];
+		return sum;
+	}
+#endif
+}
+
+std::unique_ptr<network> eval::nnue::load_network(const std::string& path)
+{
+	std::ifstream in{path,std::ios::binary};
+	if(!in)
+		return nullptr;
+
+	std::uint32_t version, hash, description_size;
+	if(!read(in,&version,1) || !read(in,&hash,1) || !read(in,&description_size,1) || version!=file_version || hash!=network_hash)
+		return nullptr;
+	in.ignore(description_size);
+
+	auto ret_val=std::make_unique<network>();
+	ret_val->feature_weights.resize(number_of_features);
+
+	const auto ok=
+		read(in,&hash,1) && hash==feature_transformer_hash &&
+		read(in,ret_val->feature_biases.values.data(),half_dimensions) &&
+		read(in,ret_val->feature_weights.data()->values.data(),number_of_features*half_dimensions) &&
+		read(in,&hash,1) && hash==hidden_layers_hash &&
+		read(in,ret_val->hidden1_biases.data(),hidden_dimensions) &&
+		read(in,ret_val->hidden1_weights.data()->data(),hidden_dimensions*2*half_dimensions) &&
+		read(in,ret_val->hidden2_biases.data(),hidden_dimensions) &&
+		read(in,ret_val->hidden2_weights.data()->data(),hidden_dimensions*hidden_dimensions) &&
+		read(in,&ret_val->output_bias,1) &&
+		read(in,ret_val->output_weights.data(),hidden_dimensions) &&
+		in.peek()==std::ifstream::traits_type::eof();
+
+	if(!ok)
+		return nullptr;
+	return ret_val;
+}
+
+bool eval::nnue::save_network(const network& net, const std::string& path)
+{
+	std::ofstream out{path,std::ios::binary};
+	const std::uint32_t description_size=0;
+
+	return
+		write(out,&file_version,1) && write(out,&network_hash,1) && write(out,&description_size,1) &&
+		write(out,&feature_transformer_hash,1) &&
+		write(out,net.feature_biases.values.data(),half_dimensions) &&
+		write(out,net.feature_weights.data()->values.data(),number_of_features*half_dimensions) &&
+		write(out,&hidden_layers_hash,1) &&
+		write(out,net.hidden1_biases.data(),hidden_dimensions) &&
+		write(out,net.hidden1_weights.data()->data(),hidden_dimensions*2*half_dimensions) &&
+		write(out,net.hidden2_biases.data(),hidden_dimensions) &&
+		write(out,net.hidden2_weights.data()->data(),hidden_dimensions*hidden_dimensions) &&
+		write(out,&net.output_bias,1) &&
+		write(out,net.output_weights.data(),hidden_dimensions);
+}
+
+void eval::nnue::refresh(const network& net, half_accumulator& half, const feature_list& features) noexcept
+{
+	add_rows(net,net.feature_biases,half,features,{});
+}
+
+void eval::nnue::update(const network& net, const half_accumulator& before, half_accumulator& after, const feature_list& added, const feature_list& removed) noexcept
+{
+	add_rows(net,before,after,added,removed);
+}
+
+int eval::nnue::evaluate(const network& net, const accumulator& acc, side to_move) noexcept
+{
+	alignas(64) transformed_t input;
+	transform(acc,to_move,input);
+
+	std::array<std::int32_t,hidden_dimensions> sums;
+	for(std::size_t i=0;i<hidden_dimensions;++i)
+		sums[i]=net.hidden1_biases[i]+dot<2*half_dimensions>(input.data(),net.hidden1_weights[i].data());
+	alignas(64) const auto hidden1=clipped_relu(sums);
+
+	for(std::size_t i=0;i<hidden_dimensions;++i)
+		sums[i]=net.hidden2_biases[i]+dot<hidden_dimensions>(hidden1.data(),net.hidden2_weights[i].data());
+	alignas(64) const auto hidden2=clipped_relu(sums);
+
+	const auto output=net.output_bias+dot<hidden_dimensions>(hidden2.data(),net.output_weights.data());
+	return output/output_scale*100/pawn_value;
+}
@@ -4,7 +4,7 @@ using namespace philchess;
 
 namespace
 {
-	constexpr auto init_phase_factor_table()
+	constexpr auto init_phase_factor_table() noexcept
 	{
 		eval::material_factors<int> ret_val{};
 		ret_val[eval::compute_material_factor_key({0,0,0,0})]=188;
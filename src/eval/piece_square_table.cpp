@@ -8,15 +8,6 @@ namespace
 	{
 		eval::piece_square_table<int> ret_val{};
 
-		piece_type_map<int> base_value_map;
-		base_value_map[piece_type::pawn]=100;
-		base_value_map[piece_type::bishop]=360;
-		base_value_map[piece_type::knight]=319;
-		base_value_map[piece_type::rook]=631;
-		base_value_map[piece_type::queen]=796;
-		base_value_map[piece_type::king]=10000;
-		base_value_map[piece_type::none]=0;
-
 		ret_val[side::white][piece_type::pawn][square{0}]=101;
 		ret_val[side::white][piece_type::pawn][square{1}]=101;
 		ret_val[side::white][piece_type::pawn][square{2}]=101;
@@ -419,7 +410,7 @@ namespace
 				ret_val[side::black][piece_id][sq]=ret_val[side::white][piece_id][opponent_sq];
 			}
 		};
-				
+
 		return ret_val;
 	}
 
@@ -427,15 +418,6 @@ namespace
 	{
 		eval::piece_square_table<int> ret_val{};
 
-		piece_type_map<int> base_value_map;
-		base_value_map[piece_type::pawn]=100;
-		base_value_map[piece_type::bishop]=279;
-		base_value_map[piece_type::knight]=216;
-		base_value_map[piece_type::rook]=764;
-		base_value_map[piece_type::queen]=168;
-		base_value_map[piece_type::king]=10000;
-		base_value_map[piece_type::none]=0;
-
 		ret_val[side::white][piece_type::pawn][square{0}]=101;
 		ret_val[side::white][piece_type::pawn][square{1}]=101;
 		ret_val[side::white][piece_type::pawn][square{2}]=101;
@@ -838,7 +820,7 @@ namespace
 				ret_val[side::black][piece_id][sq]=ret_val[side::white][piece_id][opponent_sq];
 			}
 		};
-				
+
 		return ret_val;
 	}
 
@@ -0,0 +1,93 @@
+#include <philchess/perft.hpp>
+
+#include <ptl/bit.hpp>
+
+#include <algorithm>
+#include <thread>
+
+using namespace philchess;
+
+namespace
+{
+	std::uint64_t count_nodes(chessboard& board, unsigned depth, perft_hash_table* hash_table) noexcept
+	{
+		if(depth==0)
+			return 1;
+
+		const auto moves=board.list_moves();
+		if(depth==1)
+			return moves.size();
+
+		if(hash_table)
+		{
+			if(const auto nodes=hash_table->probe(board.hash(),depth))
+				return *nodes;
+		}
+
+		std::uint64_t ret_val=0;
+		for(const auto m: moves)
+		{
+			const auto undo=board.do_move(m);
+			ret_val+=count_nodes(board,depth-1,hash_table);
+			board.undo_move(undo);
+		}
+
+		if(hash_table)
+			hash_table->store(board.hash(),depth,ret_val);
+
+		return ret_val;
+	}
+}
+
+perft_hash_table::perft_hash_table(std::size_t size_in_mb):
+	number_of_entries_{ptl::bit_floor(std::max<std::size_t>(size_in_mb*1024*1024/sizeof(entry_t),2))},
+	entries_{std::make_unique<entry_t[]>(number_of_entries_)}
+{}
+
+perft_result philchess::perft(const chessboard& board, unsigned depth, perft_options options)
+{
+	const auto start_time=std::chrono::steady_clock::now();
+
+	perft_result ret_val;
+	for(const auto m: board.list_moves())
+		ret_val.divide.emplace_back(m,0);
+
+	std::unique_ptr<perft_hash_table> hash_table;
+	if(options.hash_size_in_mb>0)
+		hash_table=std::make_unique<perft_hash_table>(options.hash_size_in_mb);
+
+	if(depth==0)
+	{
+		ret_val.divide.clear();
+		ret_val.nodes=1;
+	}
+	else
+	{
+		//the root moves are handed out one by one to whichever thread is free, every thread playing them on its own copy of the board
+		std::atomic<std::size_t> next_root_move{0};
+		auto worker=[&, root_board=board]() mutable
+		{
+			root_board.set_prefetch_hook(nullptr,nullptr); //whatever the board was prefetching for, it is of no use here
+			for(auto idx=next_root_move++;idx<ret_val.divide.size();idx=next_root_move++)
+			{
+				auto& [m, nodes]=ret_val.divide[idx];
+				const auto undo=root_board.do_move(m);
+				nodes=count_nodes(root_board,depth-1,hash_table.get());
+				root_board.undo_move(undo);
+			}
+		};
+
+		std::vector<std::thread> helpers;
+		for(unsigned i=1;i<options.threads;++i)
+			helpers.emplace_back(worker);
+		worker();
+		for(auto& thd: helpers)
+			thd.join();
+
+		for(const auto& [m, nodes]: ret_val.divide)
+			ret_val.nodes+=nodes;
+	}
+
+	ret_val.elapsed=std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-start_time);
+	return ret_val;
+}
@@ -0,0 +1,237 @@
+#include <philchess/position_record.hpp>
+
+#include <philchess/chessboard.hpp>
+
+#include <ptl/bit.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <filesystem>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace philchess;
+
+position_record philchess::make_position_record(const chessboard& board, std::int16_t score, game_result result) noexcept
+{
+	position_record ret_val{};
+	ret_val.score=score;
+	ret_val.result=result;
+
+	std::size_t index=0;
+	for(std::uint8_t id=0;id<64;++id)
+	{
+		const square sq{id};
+		const auto type=board.piece_type_at(sq);
+		if(type==piece_type::none)
+			continue;
+
+		const auto nibble=static_cast<std::uint8_t>(static_cast<std::uint8_t>(type)|(board.owner_at(sq)==side::black?8:0));
+		ret_val.occupancy|=std::uint64_t{1}<<id;
+		ret_val.pieces[index/2]|=index%2==0?nibble:nibble<<4;
+		++index;
+	}
+
+	const auto castling=board.castling_rights();
+	ret_val.flags=static_cast<std::uint8_t>(
+		(board.side_to_move()==side::black?1:0)|
+		static_cast<std::uint8_t>(castling[side::white])<<1|
+		static_cast<std::uint8_t>(castling[side::black])<<3);
+	ret_val.enpassant_file=board.enpassant_file();
+	ret_val.fifty_move_counter=board.fifty_move_counter();
+
+	return ret_val;
+}
+
+bool position_record::is_valid() const noexcept
+{
+	const auto count=ptl::popcount(occupancy);
+	if(count>32 || enpassant_file>8 || result>game_result::unknown)
+		return false;
+	
+	side_map<unsigned> kings{{{0,0}}};
+	for(std::size_t index=0;index<static_cast<std::size_t>(count);++index)
+	{
+		const auto nibble=(pieces[index/2]>>(index%2==0?0:4))&0xf;
+		const auto type=static_cast<unsigned>(nibble&0x7);
+		if(type>static_cast<unsigned>(piece_type::king))
+			return false;
+		if(type==static_cast<unsigned>(piece_type::king))
+			++kings[(nibble&0x8)?side::black:side::white];
+	}
+	
+	return kings[side::white]==1 && kings[side::black]==1;
+}
+
+std::optional<position_record> philchess::parse_labelled_position(std::string_view line)
+{
+	std::vector<std::string_view> tokens;
+	while(!line.empty())
+	{
+		const auto begin=line.find_first_not_of(" \t\r");
+		if(begin==std::string_view::npos)
+			break;
+		line.remove_prefix(begin);
+		const auto length=std::min(line.find_first_of(" \t\r"),line.size());
+		tokens.push_back(line.substr(0,length));
+		line.remove_prefix(length);
+	}
+	
+	//setup trusts whatever it is given, so at least make sure this is going to look like a position to it
+	const auto count=[](std::string_view token, char c){ return std::count(std::begin(token),std::end(token),c); };
+	if(tokens.size()<4 || count(tokens[0],'/')!=7 || count(tokens[0],'K')!=1 || count(tokens[0],'k')!=1 || (tokens[1]!="w" && tokens[1]!="b"))
+		return std::nullopt;
+	
+	const auto is_number=[](std::string_view token){ return !token.empty() && std::all_of(std::begin(token),std::end(token),[](char c){ return std::isdigit(static_cast<unsigned char>(c))!=0; }); };
+	const auto to_int=[](std::string_view token)
+	{
+		int ret_val=0;
+		std::from_chars(token.data(),token.data()+token.size(),ret_val);
+		return ret_val;
+	};
+	
+	std::string fen;
+	for(std::size_t i=0;i<4;++i)
+		fen+=std::string{tokens[i]}+' ';
+	
+	std::size_t next=4;
+	std::string clocks="0 1";
+	if(tokens.size()>=6 && is_number(tokens[4]) && is_number(tokens[5]))
+	{
+		clocks=std::string{tokens[4]}+' '+std::string{tokens[5]};
+		next=6;
+	}
+	
+	auto score=position_record::no_score;
+	auto result=game_result::unknown;
+	for(auto i=next;i<tokens.size();++i)
+	{
+		std::string token{tokens[i]};
+		token.erase(std::remove_if(std::begin(token),std::end(token),[](char c){ return c=='"' || c==';' || c=='[' || c==']'; }),std::end(token));
+		
+		const auto operand=[&]()
+		{
+			std::string ret_val{i+1<tokens.size()?tokens[++i]:""};
+			ret_val.erase(std::remove(std::begin(ret_val),std::end(ret_val),';'),std::end(ret_val));
+			return ret_val;
+		};
+		
+		if(token=="1-0" || token=="1.0")
+			result=game_result::white_wins;
+		else if(token=="0-1" || token=="0.0")
+			result=game_result::black_wins;
+		else if(token=="1/2-1/2" || token=="0.5")
+			result=game_result::draw;
+		else if(token=="ce")
+		{
+			const auto ce=std::clamp(to_int(operand()),-32767,32767);
+			score=static_cast<std::int16_t>(tokens[1]=="w"?ce:-ce);
+		}
+		else if(token=="hmvc")
+		{
+			const auto counter=operand();
+			if(next==4 && is_number(counter))
+				clocks=counter+" 1";
+		}
+	}
+	
+	chessboard board;
+	board.setup(fen+clocks);
+	return make_position_record(board,score,result);
+}
+
+std::string philchess::format_labelled_position(const position_record& record)
+{
+	chessboard board;
+	board.setup(record);
+	auto ret_val=board.fen();
+	
+	switch(record.result)
+	{
+		case game_result::white_wins: ret_val+=" c9 \"1-0\";"; break;
+		case game_result::black_wins: ret_val+=" c9 \"0-1\";"; break;
+		case game_result::draw: ret_val+=" c9 \"1/2-1/2\";"; break;
+		case game_result::unknown: break;
+	}
+	
+	if(record.score!=position_record::no_score)
+		ret_val+=" ce "+std::to_string(record.side_to_move()==side::white?record.score:-record.score)+";";
+	
+	return ret_val;
+}
+
+position_record_writer::position_record_writer(const std::string& path, bool append):
+	out_{path,std::ios::binary|(append?std::ios::app:std::ios::trunc)}
+{}
+
+bool position_record_writer::write(const position_record& record)
+{
+	return write(&record,1);
+}
+
+bool position_record_writer::write(const position_record* records, std::size_t count)
+{
+	return static_cast<bool>(out_.write(reinterpret_cast<const char*>(records),static_cast<std::streamsize>(count*sizeof(position_record))));
+}
+
+bool position_record_writer::flush()
+{
+	return static_cast<bool>(out_.flush());
+}
+
+position_record_file::position_record_file(const std::string& path)
+{
+	std::error_code error;
+	const auto size_in_bytes=std::filesystem::file_size(path,error);
+	if(error || size_in_bytes%sizeof(position_record)!=0)
+		return;
+
+	size_=size_in_bytes/sizeof(position_record);
+	if(size_==0)
+	{
+		open_=true;
+		return;
+	}
+
+#ifdef __linux__
+	const auto fd=::open(path.c_str(),O_RDONLY);
+	if(fd>=0)
+	{
+		auto memory=mmap(nullptr,size_in_bytes,PROT_READ,MAP_PRIVATE,fd,0);
+		::close(fd); //the mapping stays valid without it
+		if(memory!=MAP_FAILED)
+		{
+			madvise(memory,size_in_bytes,MADV_SEQUENTIAL);
+			mapping_=memory;
+			mapping_size_=size_in_bytes;
+			records_=static_cast<const position_record*>(memory);
+			open_=true;
+			return;
+		}
+	}
+#endif
+
+	std::ifstream in{path,std::ios::binary};
+	fallback_.resize(size_);
+	if(!in.read(reinterpret_cast<char*>(fallback_.data()),static_cast<std::streamsize>(size_in_bytes)))
+	{
+		fallback_.clear();
+		size_=0;
+		return;
+	}
+	records_=fallback_.data();
+	open_=true;
+}
+
+position_record_file::~position_record_file()
+{
+#ifdef __linux__
+	if(mapping_)
+		munmap(mapping_,mapping_size_);
+#endif
+}
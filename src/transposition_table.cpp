@@ -0,0 +1,61 @@
+#include <philchess/transposition_table.hpp>
+
+#include <memory>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+using namespace philchess;
+
+namespace
+{
+	constexpr std::size_t huge_page_size=2*1024*1024;
+}
+
+transposition_table::bucket_ptr transposition_table::allocate(std::size_t number_of_buckets, bool use_large_pages)
+{
+	const auto size_in_bytes=number_of_buckets*sizeof(bucket_t);
+
+	const auto construct=[number_of_buckets](void* memory, memory_deleter deleter)
+	{
+		auto buckets=static_cast<bucket_t*>(memory);
+		std::uninitialized_default_construct_n(buckets,number_of_buckets);
+		return bucket_ptr{buckets,deleter};
+	};
+
+#ifdef __linux__
+	if(use_large_pages)
+	{
+		const auto rounded_size=(size_in_bytes+huge_page_size-1)/huge_page_size*huge_page_size;
+
+		//Explicit huge pages are only available if someone reserved them beforehand(vm.nr_hugepages)...
+		auto memory=mmap(nullptr,rounded_size,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB,-1,0);
+		if(memory!=MAP_FAILED)
+			return construct(memory,{rounded_size,huge_page_size,page_type::huge});
+
+		//...otherwise ask for transparent ones, which works out of the box on most systems, as long as they are not disabled completely.
+		memory=::operator new(rounded_size,std::align_val_t{huge_page_size});
+		const auto type=madvise(memory,rounded_size,MADV_HUGEPAGE)==0?page_type::transparent_huge:page_type::normal;
+		return construct(memory,{rounded_size,huge_page_size,type});
+	}
+#else
+	(void)use_large_pages; //no idea how to get them elsewhere, feel free to add ;-)
+#endif
+
+	return construct(::operator new(size_in_bytes,std::align_val_t{alignof(bucket_t)}),{size_in_bytes,alignof(bucket_t),page_type::normal});
+}
+
+void transposition_table::memory_deleter::operator()(bucket_t* buckets) const noexcept
+{
+	//buckets are trivially destructible, so there is no need to destroy them one by one
+#ifdef __linux__
+	if(type==page_type::huge)
+	{
+		munmap(buckets,size_in_bytes);
+		return;
+	}
+#endif
+	::operator delete(buckets,std::align_val_t{alignment});
+}
@@ -0,0 +1,75 @@
+#include "random_games.hpp"
+
+#include <philchess/chessboard.hpp>
+
+#include <philchess/eval/default_evaluation.hpp>
+#include <philchess/eval/evaluation_parameters.hpp>
+#include <philchess/eval/pawn_hash.hpp>
+
+#include <iostream>
+#include <random>
+#include <string_view>
+
+#include <cstdlib>
+
+/**
+ * Plays random games and checks in every position, that default_evaluation gives the same, whether it takes the piece square sums from the board
+ * or sums up the tables in the parameters itself, as tools/tune has it do. Also makes sure that changing a table there changes the evaluation.
+ *
+ * Usage: evaluation_parameters [games_per_position=50]
+**/
+
+using namespace philchess;
+
+namespace
+{
+	constexpr std::string_view positions[]=
+	{
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+		"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+		"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned games_per_position=argc>1?std::stoul(argv[1]):50;
+
+	const auto& board_sums=eval::get_default_evaluation_parameters();
+	auto own_sums=board_sums;
+	own_sums.board_sums_piece_square_tables=false;
+
+	auto changed=own_sums;
+	for(std::uint8_t id=0;id<64;++id)
+	{
+		changed.middlegame_pst[side::white][piece_type::king][square{id}]+=50;
+		changed.endgame_pst[side::white][piece_type::king][square{id}]+=50;
+	}
+
+	eval::pawn_hash_table pawn_cache;
+	std::mt19937 rng{42};
+	unsigned long checked_positions=0;
+	unsigned errors=0;
+
+	tests::for_each_random_position(positions,games_per_position,rng,[&](chessboard& board, std::string_view, unsigned)
+	{
+		const auto expected=eval::default_evaluation<int>(board,board_sums,pawn_cache);
+		if(eval::default_evaluation<int>(board,own_sums,pawn_cache)!=expected && ++errors<10)
+			std::cerr<<"piece square sums differ in\n"<<board<<std::endl;
+
+		const auto white_relative=board.side_to_move()==side::white?1:-1;
+		const auto difference=eval::default_evaluation<int>(board,changed,pawn_cache)-expected;
+		if(expected!=0 && std::abs(difference-50*white_relative)>1 && ++errors<10) //phase blended, but both halves moved by the same. off by one at most from the rounding
+			std::cerr<<"changed table not used in\n"<<board<<std::endl;
+
+		++checked_positions;
+	});
+
+	if(errors>0)
+	{
+		std::cout<<errors<<" errors in "<<checked_positions<<" positions ;_;"<<std::endl;
+		return 1;
+	}
+	std::cout<<"OK, "<<checked_positions<<" positions checked"<<std::endl;
+}
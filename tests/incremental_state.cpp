@@ -0,0 +1,74 @@
+#include "random_games.hpp"
+
+#include <philchess/chessboard.hpp>
+
+#include <iostream>
+#include <random>
+#include <string_view>
+
+/**
+ * Plays random games from a couple of positions and checks after every do_move, undo_move, do_nullmove and undo_nullmove,
+ * that everything the board maintains incrementally(hashes, material signature, piece square sums) still matches a
+ * recomputation from scratch.
+ *
+ * Usage: incremental_state [games_per_position=200]
+**/
+
+using namespace philchess;
+
+namespace
+{
+	constexpr std::string_view positions[]=
+	{
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", //castling, enpassant and promotions galore
+		"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+		"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+		"n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned games_per_position=argc>1?std::stoul(argv[1]):200;
+	
+	std::mt19937 rng{42};
+	unsigned long checks=0;
+	unsigned errors=0;
+	
+	tests::for_each_random_position(positions,games_per_position,rng,[&](chessboard& board, std::string_view fen, unsigned ply)
+	{
+		const auto check=[&](std::string_view what)
+		{
+			++checks;
+			if(!board.incremental_state_is_consistent() && ++errors<10)
+				std::cerr<<"Inconsistent state after "<<what<<" at ply "<<ply<<" from "<<fen<<std::endl;
+		};
+		check(ply==0?"setup":"do_move");
+		
+		//try every move once and take it back
+		for(const auto m: board.list_moves())
+		{
+			const auto undo=board.do_move(m);
+			check("do_move");
+			board.undo_move(undo);
+			check("undo_move");
+		}
+		
+		if(!board.is_in_check() && rng()%8==0)
+		{
+			const auto undo=board.do_nullmove();
+			check("do_nullmove");
+			board.undo_nullmove(undo);
+			check("undo_nullmove");
+		}
+	});
+	
+	if(errors>0)
+	{
+		std::cout<<errors<<" errors in "<<checks<<" positions ;_;"<<std::endl;
+		return 1;
+	}
+	std::cout<<"OK, "<<checks<<" positions checked"<<std::endl;
+	return 0;
+}
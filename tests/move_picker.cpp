@@ -0,0 +1,147 @@
+#include "random_games.hpp"
+
+#include <philchess/chessboard.hpp>
+#include <philchess/move_picker.hpp>
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <vector>
+
+/**
+ * Plays random games and checks in every position, that
+ *  - list_noisy_moves and list_quiet_moves together are exactly list_moves,
+ *  - the pseudo legal ones are the same, once everything that fails leaves_king_safe is thrown out,
+ *  - is_legal agrees with list_moves, for the legal moves as well as for random garbage and moves from earlier positions,
+ *  - would_check is right about every legal move,
+ *  - the move picker hands out every legal move exactly once, whatever hash move and killers it is given.
+ *
+ * Usage: move_picker [games_per_position=100]
+**/
+
+using namespace philchess;
+
+namespace
+{
+	constexpr std::string_view positions[]=
+	{
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+		"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+		"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+		"n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+		"8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",
+		"r3k3/8/8/8/8/8/8/4K2R w Kq - 0 1", //castling gives check
+	};
+
+	template <typename T>
+	std::vector<move> sorted(const T& moves)
+	{
+		std::vector<move> ret_val(std::begin(moves),std::end(moves));
+		std::sort(std::begin(ret_val),std::end(ret_val),[](auto lhs, auto rhs){ return lhs.value()<rhs.value(); });
+		return ret_val;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned games_per_position=argc>1?std::stoul(argv[1]):100;
+
+	std::mt19937 rng{42};
+	unsigned long checked_positions=0;
+	unsigned errors=0;
+
+	const auto report=[&](std::string_view what, const chessboard& board, move m)
+	{
+		if(++errors<10)
+			std::cerr<<what<<' '<<m<<" in\n"<<board<<std::endl;
+	};
+
+	move_picker::history_table history{};
+
+	std::vector<move> earlier_moves;
+	tests::for_each_random_position(positions,games_per_position,rng,[&](chessboard& board, std::string_view, unsigned ply)
+	{
+		if(ply==0)
+			earlier_moves.clear();
+
+		const auto moves=board.list_moves();
+		const auto all=sorted(moves);
+		const auto is_listed=[&](move m){ return std::binary_search(std::begin(all),std::end(all),m,[](auto lhs, auto rhs){ return lhs.value()<rhs.value(); }); };
+
+		std::vector<move> split;
+		for(const auto m: board.list_noisy_moves())
+			split.push_back(m);
+		for(const auto m: board.list_quiet_moves())
+			split.push_back(m);
+		if(sorted(split)!=all)
+			report("noisy and quiet moves do not add up",board,move{});
+
+		std::vector<move> pseudo_legal;
+		for(const auto m: board.list_pseudo_legal_noisy_moves())
+			pseudo_legal.push_back(m);
+		for(const auto m: board.list_pseudo_legal_quiet_moves())
+			pseudo_legal.push_back(m);
+		std::vector<move> safe;
+		for(const auto m: pseudo_legal)
+		{
+			if(board.is_in_check() || board.leaves_king_safe(m))
+				safe.push_back(m);
+			else if(is_listed(m))
+				report("legal move thought to leave the king in check",board,m);
+		}
+		if(sorted(safe)!=all)
+			report("pseudo legal moves do not match the legal ones",board,move{});
+
+		for(const auto m: moves)
+		{
+			const auto undo=board.do_move(m);
+			const auto gives_check=board.is_in_check();
+			board.undo_move(undo);
+			if(board.would_check(m)!=gives_check)
+				report(gives_check?"check not seen coming":"check that never was",board,m);
+		}
+		
+		std::vector<move> candidates(std::begin(moves),std::end(moves));
+		for(unsigned i=0;i<64;++i)
+			candidates.push_back(move::from_value(static_cast<std::uint16_t>(rng())));
+		candidates.insert(std::end(candidates),std::begin(earlier_moves),std::end(earlier_moves));
+
+		for(const auto m: candidates)
+		{
+			if(board.is_legal(m)!=is_listed(m))
+				report(is_listed(m)?"legal move rejected":"illegal move accepted",board,m);
+		}
+
+		for(std::uint8_t type=0;type<7;++type)
+		{
+			for(std::uint8_t id=0;id<64;++id)
+				history[static_cast<piece_type>(type)][square{id}]=rng()%16;
+		}
+
+		const auto pick=[&](){ return candidates[rng()%candidates.size()]; };
+		move_picker picker{board,pick(),{pick(),pick()},history};
+		std::vector<move> picked;
+		for(const auto m: picker)
+			picked.push_back(m);
+		if(sorted(picked)!=all)
+			report("move picker did not return every move exactly once",board,move{});
+
+		++checked_positions;
+		if(!moves.empty())
+		{
+			earlier_moves.push_back(moves[rng()%moves.size()]);
+			if(earlier_moves.size()>32)
+				earlier_moves.erase(std::begin(earlier_moves));
+		}
+	});
+
+	if(errors>0)
+	{
+		std::cout<<errors<<" errors in "<<checked_positions<<" positions ;_;"<<std::endl;
+		return 1;
+	}
+	std::cout<<"OK, "<<checked_positions<<" positions checked"<<std::endl;
+}
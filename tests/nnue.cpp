@@ -0,0 +1,211 @@
+#include "random_games.hpp"
+
+#include <philchess/chessboard.hpp>
+#include <philchess/eval/nnue.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Saves a network with random weights, loads it again and plays random games with it set on the board, checking in every position, that
+ *  - the accumulators do_move and undo_move kept up to date are the same as computed from scratch,
+ *  - evaluate, whichever kernels it was built with, gives the same as a plain forward pass written down right here.
+ * Also makes sure broken files are rejected. There is no real net in the repository, so nothing here says anything about playing strength ;-)
+ *
+ * Usage: nnue [games_per_position=20]
+**/
+
+using namespace philchess;
+using namespace philchess::eval::nnue;
+
+namespace
+{
+	constexpr std::string_view positions[]=
+	{
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+		"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+		"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+		"n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+	};
+
+	network random_network(std::mt19937& rng)
+	{
+		const auto uniform=[&](int min, int max){ return std::uniform_int_distribution<int>{min,max}(rng); };
+
+		network ret_val;
+		ret_val.feature_weights.resize(number_of_features);
+		for(auto& value: ret_val.feature_biases.values)
+			value=static_cast<std::int16_t>(uniform(-64,96));
+		for(auto& row: ret_val.feature_weights)
+		{
+			for(auto& value: row.values)
+				value=static_cast<std::int16_t>(uniform(-24,24)); //small enough to never overflow, large enough to clip now and then
+		}
+		for(std::size_t i=0;i<hidden_dimensions;++i)
+		{
+			ret_val.hidden1_biases[i]=uniform(-8000,8000);
+			ret_val.hidden2_biases[i]=uniform(-2000,2000);
+			ret_val.output_weights[i]=static_cast<std::int8_t>(uniform(-128,127));
+			for(auto& weight: ret_val.hidden1_weights[i])
+				weight=static_cast<std::int8_t>(uniform(-128,127));
+			for(auto& weight: ret_val.hidden2_weights[i])
+				weight=static_cast<std::int8_t>(uniform(-128,127));
+		}
+		ret_val.output_bias=uniform(-1000,1000);
+		return ret_val;
+	}
+
+	half_accumulator from_scratch(const network& net, const chessboard& board, side perspective)
+	{
+		square own_king;
+		for(std::uint8_t id=0;id<64;++id)
+		{
+			if(board.piece_type_at(square{id})==piece_type::king && board.owner_at(square{id})==perspective)
+				own_king=square{id};
+		}
+
+		half_accumulator ret_val=net.feature_biases;
+		for(std::uint8_t id=0;id<64;++id)
+		{
+			const square sq{id};
+			const auto type=board.piece_type_at(sq);
+			if(type==piece_type::none || type==piece_type::king)
+				continue;
+
+			const auto& row=net.feature_weights[feature_index(perspective,own_king,board.owner_at(sq),type,sq)];
+			for(std::size_t i=0;i<half_dimensions;++i)
+				ret_val.values[i]+=row.values[i];
+		}
+		return ret_val;
+	}
+
+	int forward_pass(const network& net, const chessboard& board)
+	{
+		const auto to_move=board.side_to_move();
+
+		std::vector<int> input;
+		for(const auto s: {to_move,reverse(to_move)})
+		{
+			for(const auto value: from_scratch(net,board,s).values)
+				input.push_back(std::clamp<int>(value,0,127));
+		}
+
+		std::vector<int> hidden1, hidden2;
+		for(std::size_t i=0;i<hidden_dimensions;++i)
+		{
+			int sum=net.hidden1_biases[i];
+			for(std::size_t j=0;j<input.size();++j)
+				sum+=input[j]*net.hidden1_weights[i][j];
+			hidden1.push_back(std::clamp(sum/64-(sum%64<0?1:0),0,127)); //rounding down, as the shift does
+		}
+		for(std::size_t i=0;i<hidden_dimensions;++i)
+		{
+			int sum=net.hidden2_biases[i];
+			for(std::size_t j=0;j<hidden_dimensions;++j)
+				sum+=hidden1[j]*net.hidden2_weights[i][j];
+			hidden2.push_back(std::clamp(sum/64-(sum%64<0?1:0),0,127));
+		}
+
+		int output=net.output_bias;
+		for(std::size_t j=0;j<hidden_dimensions;++j)
+			output+=hidden2[j]*net.output_weights[j];
+		return output/16*100/208;
+	}
+
+	bool same(const accumulator& lhs, const half_accumulator& white, const half_accumulator& black)
+	{
+		return lhs.halves[side::white].values==white.values && lhs.halves[side::black].values==black.values;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned games_per_position=argc>1?std::stoul(argv[1]):20;
+
+	std::mt19937 rng{42};
+	const auto net=random_network(rng);
+
+	const auto path=(std::filesystem::temp_directory_path()/"philchess_nnue_test.nnue").string();
+	if(!save_network(net,path))
+	{
+		std::cout<<"Could not write "<<path<<" ;_;"<<std::endl;
+		return 1;
+	}
+	const auto loaded=load_network(path);
+
+	unsigned errors=0;
+	const auto fail=[&](std::string_view what)
+	{
+		if(++errors<10)
+			std::cerr<<what<<std::endl;
+	};
+
+	if(!loaded)
+		fail("network could not be loaded again");
+	else if(loaded->feature_weights[12345].values!=net.feature_weights[12345].values || loaded->output_weights!=net.output_weights || loaded->output_bias!=net.output_bias)
+		fail("network loaded is not the one saved");
+
+	{
+		std::ifstream in{path,std::ios::binary};
+		std::string contents{std::istreambuf_iterator<char>{in},std::istreambuf_iterator<char>{}};
+
+		std::ofstream{path,std::ios::binary}<<contents.substr(0,contents.size()-1);
+		if(load_network(path))
+			fail("truncated network accepted");
+
+		contents[0]^=1;
+		std::ofstream{path,std::ios::binary}<<contents;
+		if(load_network(path))
+			fail("network with the wrong version accepted");
+
+		if(load_network(path+".does_not_exist"))
+			fail("network that does not exist accepted");
+	}
+	std::filesystem::remove(path);
+
+	unsigned long checked_positions=0;
+	tests::for_each_random_position(positions,games_per_position,rng,[&](chessboard& board, std::string_view fen, unsigned ply)
+	{
+		if(ply==0)
+			board.set_network(&net);
+
+		const auto check=[&](std::string_view what)
+		{
+			++checked_positions;
+			if(!same(board.accumulator(),from_scratch(net,board,side::white),from_scratch(net,board,side::black)))
+				fail(std::string{"accumulator differs after "}+std::string{what}+" in "+std::string{fen});
+			if(evaluate(net,board.accumulator(),board.side_to_move())!=forward_pass(net,board))
+				fail(std::string{"evaluation differs after "}+std::string{what}+" in "+std::string{fen});
+		};
+		check(ply==0?"setup":"do_move");
+
+		for(const auto m: board.list_moves())
+		{
+			const auto undo=board.do_move(m);
+			check("do_move");
+			board.undo_move(undo);
+		}
+		check("undo_move");
+
+		if(!board.is_in_check() && rng()%8==0)
+		{
+			const auto data=board.do_nullmove();
+			check("do_nullmove");
+			board.undo_nullmove(data);
+		}
+	});
+
+	if(errors>0)
+	{
+		std::cout<<errors<<" errors in "<<checked_positions<<" positions ;_;"<<std::endl;
+		return 1;
+	}
+	std::cout<<"OK, "<<checked_positions<<" positions checked"<<std::endl;
+}
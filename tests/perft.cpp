@@ -0,0 +1,94 @@
+#include <philchess/chessboard.hpp>
+#include <philchess/perft.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <cstdint>
+#include <cstdlib>
+
+/**
+ * Runs perft on a couple of well known positions(most of them from the chessprogramming wiki, the smaller ones are Martin Sedlaks collection of nasty edge cases)
+ * and compares with their known node counts. Anything that differs is a bug in move generation or do_move/undo_move.
+ * Usage: perft [threads] [hash size in mb]
+**/
+
+using namespace philchess;
+
+namespace
+{
+	struct test_position
+	{
+		const char* fen;
+		unsigned depth;
+		std::uint64_t nodes;
+	};
+
+	const test_position suite[]=
+	{
+		{"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",5,4865609},
+		{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",4,4085603},
+		{"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",6,11030083},
+		{"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",5,15833292},
+		{"r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",5,15833292},
+		{"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",4,2103487},
+		{"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",4,3894594},
+
+		{"3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1",6,1134888}, //avoid illegal en passant capture
+		{"8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1",6,1015133}, //en passant capture checks opponent
+		{"8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",6,1440467},
+		{"5k2/8/8/8/8/8/8/4K2R w K - 0 1",6,661072}, //short castling gives check
+		{"3k4/8/8/8/8/8/8/R3K3 w Q - 0 1",6,803711}, //long castling gives check
+		{"r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1",4,1274206}, //castling rights
+		{"r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1",4,1720476}, //castling prevented
+		{"2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1",6,3821001}, //promote out of check
+		{"8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1",5,1004658}, //discovered check
+		{"4k3/1P6/8/8/8/8/K7/8 w - - 0 1",6,217342}, //promote to give check
+		{"8/P1k5/K7/8/8/8/8/8 w - - 0 1",6,92683}, //underpromote to check
+		{"K1k5/8/P7/8/8/8/8/8 w - - 0 1",6,2217}, //self stalemate
+		{"8/k1P5/8/1K6/8/8/8/8 w - - 0 1",7,567584}, //stalemate and checkmate
+		{"8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1",4,23527} //double check
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	perft_options options;
+	if(argc>1)
+		options.threads=std::stoul(argv[1]);
+	if(argc>2)
+		options.hash_size_in_mb=std::stoul(argv[2]);
+
+	unsigned errors=0;
+	std::uint64_t total_nodes=0, total_ms=0;
+
+	for(const auto& pos: suite)
+	{
+		chessboard board;
+		board.setup(pos.fen);
+
+		const auto result=perft(board,pos.depth,options);
+		const auto ms=static_cast<std::uint64_t>(result.elapsed.count());
+		total_nodes+=result.nodes;
+		total_ms+=ms;
+
+		std::cout<<std::setw(80)<<std::left<<pos.fen<<" depth "<<pos.depth<<": "<<std::setw(10)<<std::right<<result.nodes<<" nodes in "<<std::setw(6)<<ms<<"ms";
+		if(result.nodes!=pos.nodes)
+		{
+			++errors;
+			std::cout<<" MISMATCH, expected "<<pos.nodes;
+		}
+		std::cout<<'\n';
+	}
+
+	std::cout<<"Total: "<<total_nodes<<" nodes in "<<total_ms<<"ms, "<<std::fixed<<std::setprecision(2)<<total_nodes/1000.0/std::max<std::uint64_t>(total_ms,1)<<" Mnps"<<std::endl;
+
+	if(errors>0)
+	{
+		std::cout<<errors<<" positions failed ;_;"<<std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cout<<"OK"<<std::endl;
+}
@@ -0,0 +1,141 @@
+#include "random_games.hpp"
+
+#include <philchess/chessboard.hpp>
+#include <philchess/position_record.hpp>
+
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Plays random games and checks in every position, that
+ *  - a board set up from its record is the same one: same FEN, same hash, consistent incremental state, same moves,
+ *  - a board set up from its own FEN is the same one,
+ *  - format_labelled_position and parse_labelled_position give back the same record, score and result included,
+ * and then that all the records written to a file are read back from it unchanged and that broken records are not taken for valid ones.
+ *
+ * Usage: position_record [games_per_position=50]
+**/
+
+using namespace philchess;
+
+namespace
+{
+	constexpr std::string_view positions[]=
+	{
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+		"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+		"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+		"8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",
+	};
+
+	bool same_records(const position_record& lhs, const position_record& rhs)
+	{
+		return
+			lhs.occupancy==rhs.occupancy && lhs.pieces==rhs.pieces && lhs.score==rhs.score && lhs.result==rhs.result &&
+			lhs.flags==rhs.flags && lhs.enpassant_file==rhs.enpassant_file && lhs.fifty_move_counter==rhs.fifty_move_counter;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned games_per_position=argc>1?std::stoul(argv[1]):50;
+
+	std::mt19937 rng{42};
+	unsigned errors=0;
+	const auto fail=[&](std::string_view what, std::string_view fen)
+	{
+		if(++errors<10)
+			std::cerr<<what<<' '<<fen<<std::endl;
+	};
+
+	std::vector<position_record> all_records;
+	tests::for_each_random_position(positions,games_per_position,rng,[&](chessboard& board, std::string_view, unsigned)
+	{
+		const auto score=static_cast<std::int16_t>(static_cast<int>(rng()%2001)-1000);
+		const auto result=static_cast<game_result>(rng()%4);
+		const auto record=make_position_record(board,score,result);
+		all_records.push_back(record);
+
+		chessboard from_record;
+		from_record.setup(record);
+		if(from_record.fen()!=board.fen() || from_record.hash()!=board.hash() || !from_record.incremental_state_is_consistent() || from_record.list_moves().size()!=board.list_moves().size())
+			fail("board set up from its record differs","in "+board.fen());
+
+		chessboard from_fen;
+		from_fen.setup(board.fen());
+		if(from_fen.hash()!=board.hash() || from_fen.fen()!=board.fen())
+			fail("board set up from its FEN differs","in "+board.fen());
+
+		if(!record.is_valid())
+			fail("record of a real position not valid","in "+board.fen());
+		
+		const auto parsed=parse_labelled_position(format_labelled_position(record));
+		if(!parsed || !same_records(*parsed,record))
+			fail("record does not survive the trip through text","in "+board.fen());
+	});
+
+	if(parse_labelled_position("this is no position") || parse_labelled_position("8/8/8/8/8/8/8/8 w - - 0 1"))
+		fail("garbage parsed as position","");
+
+	{
+		chessboard board;
+		board.setup(positions[0]);
+		const auto good=make_position_record(board);
+		
+		//the pieces of the start position in record order are a1 to h1 first, so the white king is the low nibble of pieces[2] and the queen the high one of pieces[1]
+		auto too_many=good, bad_type=good, no_king=good, two_kings=good, bad_enpassant=good, bad_result=good;
+		too_many.occupancy=~std::uint64_t{0};
+		bad_type.pieces[0]=static_cast<std::uint8_t>((bad_type.pieces[0]&0xf0)|0x6);
+		no_king.pieces[2]=static_cast<std::uint8_t>((no_king.pieces[2]&0xf0)|static_cast<std::uint8_t>(piece_type::queen));
+		two_kings.pieces[1]=static_cast<std::uint8_t>((two_kings.pieces[1]&0x0f)|static_cast<std::uint8_t>(piece_type::king)<<4);
+		bad_enpassant.enpassant_file=9;
+		bad_result.result=static_cast<game_result>(7);
+		
+		if(!good.is_valid())
+			fail("start position not valid","");
+		for(const auto& bad: {too_many,bad_type,no_king,two_kings,bad_enpassant,bad_result})
+		{
+			if(bad.is_valid())
+				fail("broken record taken as valid","");
+		}
+	}
+
+	const auto path=(std::filesystem::temp_directory_path()/"philchess_position_record_test.bin").string();
+	{
+		position_record_writer writer{path};
+		writer.write(all_records.data(),all_records.size()/2);
+		for(auto i=all_records.size()/2;i<all_records.size();++i)
+			writer.write(all_records[i]);
+		if(!writer.flush())
+			fail("records could not be written","");
+	}
+	{
+		const position_record_file file{path};
+		if(!file.is_open() || file.size()!=all_records.size())
+			fail("records could not be read back","");
+		else
+		{
+			for(std::size_t i=0;i<file.size();++i)
+			{
+				if(!same_records(file[i],all_records[i]))
+				{
+					fail("record read back differs","");
+					break;
+				}
+			}
+		}
+	}
+	std::filesystem::remove(path);
+
+	if(errors>0)
+	{
+		std::cout<<errors<<" errors in "<<all_records.size()<<" positions ;_;"<<std::endl;
+		return 1;
+	}
+	std::cout<<"OK, "<<all_records.size()<<" positions checked"<<std::endl;
+}
@@ -0,0 +1,104 @@
+#include <philchess/chessboard.hpp>
+#include <philchess/uci/bench_positions.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <cstdint>
+
+/**
+ * Legal move generation against pseudo legal generation with the legality check left for when a move is actually played.
+ * Walks the tree below every bench position twice, once trying every move(which is perft, all the pseudo legal work is wasted there)
+ * and once trying only the first few moves at every node, which is a lot closer to what the search does, where most nodes cut off early.
+ * For the real thing, compare the nps of bench with a build that has -DPHILCHESS_LEGAL_MOVE_GENERATION.
+ *
+ * Usage: pseudo_legal [depth=4] [width=2] [narrow_depth=8]
+**/
+
+using namespace philchess;
+
+namespace
+{
+	//tries at most width moves at every node, 0 for all of them
+	std::uint64_t walk_legal(chessboard& board, unsigned depth, unsigned width) noexcept
+	{
+		if(depth==0)
+			return 1;
+		
+		std::uint64_t ret_val=1;
+		unsigned tried=0;
+		for(const auto m: board.list_moves())
+		{
+			const auto undo=board.do_move(m);
+			ret_val+=walk_legal(board,depth-1,width);
+			board.undo_move(undo);
+			
+			if(++tried==width)
+				break;
+		}
+		return ret_val;
+	}
+	
+	std::uint64_t walk_pseudo_legal(chessboard& board, unsigned depth, unsigned width) noexcept
+	{
+		if(depth==0)
+			return 1;
+		
+		std::uint64_t ret_val=1;
+		unsigned tried=0;
+		const auto in_check=board.is_in_check();
+		const auto try_moves=[&](const auto& moves)
+		{
+			for(const auto m: moves)
+			{
+				if(!in_check && !board.leaves_king_safe(m))
+					continue;
+				
+				const auto undo=board.do_move(m);
+				ret_val+=walk_pseudo_legal(board,depth-1,width);
+				board.undo_move(undo);
+				
+				if(++tried==width)
+					return true;
+			}
+			return false;
+		};
+		
+		//like the move picker, the quiet moves are only generated if the noisy ones did not suffice
+		if(!try_moves(board.list_pseudo_legal_noisy_moves()))
+			try_moves(board.list_pseudo_legal_quiet_moves());
+		return ret_val;
+	}
+	
+	template <typename WALK>
+	void measure(const char* name, unsigned depth, unsigned width, WALK walk)
+	{
+		const auto start_time=std::chrono::steady_clock::now();
+		
+		std::uint64_t nodes=0;
+		for(const auto fen: uci::bench_positions)
+		{
+			chessboard board;
+			board.setup(fen);
+			nodes+=walk(board,depth,width);
+		}
+		
+		const auto elapsed=std::chrono::duration<double>(std::chrono::steady_clock::now()-start_time).count();
+		std::cout<<std::setw(14)<<std::left<<name<<" depth "<<depth<<", width "<<std::setw(3)<<(width==0?std::string{"all"}:std::to_string(width))<<": "
+			<<std::setw(10)<<std::right<<nodes<<" nodes in "<<std::fixed<<std::setprecision(2)<<elapsed<<"s, "<<nodes/elapsed/1e6<<" Mnps"<<std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned depth=argc>1?std::stoul(argv[1]):4;
+	const unsigned width=argc>2?std::stoul(argv[2]):2;
+	const unsigned narrow_depth=argc>3?std::stoul(argv[3]):8;
+	
+	measure("legal",depth,0,walk_legal);
+	measure("pseudo legal",depth,0,walk_pseudo_legal);
+	measure("legal",narrow_depth,width,walk_legal);
+	measure("pseudo legal",narrow_depth,width,walk_pseudo_legal);
+}
@@ -0,0 +1,43 @@
+#ifndef PHILCHESS_TESTS_RANDOM_GAMES_H
+#define PHILCHESS_TESTS_RANDOM_GAMES_H
+
+#include <philchess/chessboard.hpp>
+
+#include <random>
+#include <string_view>
+
+namespace philchess {
+namespace tests
+{
+	/*
+		The walk most of the tests here take: from every one of the given FENs, play a couple of games of random moves, up to 200 plies each, and
+		call fun(board,fen,ply) on every position along the way, the one set up(ply 0) and the last one of a game included. fun may change the board,
+		as long as it leaves it the way it found it. The moves are drawn from rng, so that a test using it for its own checks as well still plays
+		the same games every run.
+	*/
+	template <typename FENS_T, typename FUN_T>
+	void for_each_random_position(const FENS_T& fens, unsigned games_per_position, std::mt19937& rng, FUN_T fun)
+	{
+		for(const std::string_view fen: fens)
+		{
+			for(unsigned game=0;game<games_per_position;++game)
+			{
+				chessboard board;
+				board.setup(fen);
+
+				for(unsigned ply=0;ply<200;++ply)
+				{
+					fun(board,fen,ply);
+
+					const auto moves=board.list_moves();
+					if(moves.empty())
+						break;
+					board.do_move(moves[rng()%moves.size()]);
+				}
+			}
+		}
+	}
+
+}} //end namespace philchess::tests
+
+#endif
@@ -0,0 +1,71 @@
+#include <philchess/bitboard_patterns.hpp>
+
+#include <iostream>
+#include <random>
+
+/**
+ * Compares the table based sliding attacks with walking the rays square by square, for random occupancies of varying density.
+ * Build once with and once without -DPHILCHESS_USE_MAGIC_BITBOARDS to cover both backends.
+**/
+
+using namespace philchess;
+
+namespace
+{
+	bitboard::rank walk(square sq, const bitboard::rank& occupancy, std::initializer_list<std::pair<int,int>> directions)
+	{
+		bitboard::rank ret_val;
+		for(const auto& [file_step, rank_step]: directions)
+		{
+			for(int file=sq.file()+file_step, rank=sq.rank()+rank_step; file>=0 && file<8 && rank>=0 && rank<8; file+=file_step, rank+=rank_step)
+			{
+				ret_val.set(square{file,rank});
+				if((occupancy.ranks()>>square{file,rank}.id())&1)
+					break;
+			}
+		}
+		return ret_val;
+	}
+}
+
+int main()
+{
+	std::mt19937_64 rng{1};
+	unsigned errors=0;
+	
+	for(unsigned i=0;i<200000;++i)
+	{
+		auto occupancy_bits=rng();
+		for(unsigned sparse=i%4;sparse>0;--sparse)
+			occupancy_bits&=rng();
+		const auto occupancy=bitboard::rank_index::from_ranks(occupancy_bits);
+		
+		for(std::uint8_t id=0;id<64;++id)
+		{
+			const auto sq=square{id};
+			
+			const auto rook=walk(sq,occupancy,{{1,0},{-1,0},{0,1},{0,-1}});
+			const auto bishop=walk(sq,occupancy,{{1,1},{-1,-1},{1,-1},{-1,1}});
+			
+			const bool ok=
+				attacked_by_rook(sq,occupancy).ranks()==rook.ranks() &&
+				attacked_by_bishop(sq,occupancy).ranks()==bishop.ranks() &&
+				attacked_by_rook_on_file(sq,occupancy).ranks()==walk(sq,occupancy,{{0,1},{0,-1}}).ranks() &&
+				attacked_by_rook_on_rank(sq,occupancy).ranks()==walk(sq,occupancy,{{1,0},{-1,0}}).ranks() &&
+				attacked_by_bishop_on_diagonal(sq,occupancy).ranks()==walk(sq,occupancy,{{1,-1},{-1,1}}).ranks() &&
+				attacked_by_bishop_on_antidiagonal(sq,occupancy).ranks()==walk(sq,occupancy,{{1,1},{-1,-1}}).ranks();
+			
+			if(!ok && ++errors<10)
+				std::cerr<<"Mismatch on square "<<static_cast<int>(id)<<" with occupancy "<<std::hex<<occupancy_bits<<std::dec<<std::endl;
+		}
+	}
+	
+	if(errors!=0)
+	{
+		std::cerr<<errors<<" mismatches"<<std::endl;
+		return 1;
+	}
+	
+	std::cout<<"OK"<<std::endl;
+	return 0;
+}
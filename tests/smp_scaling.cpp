@@ -0,0 +1,84 @@
+#include "../src/engine/paulchen332.hpp"
+#include "../src/engine/silent_controller.hpp"
+
+#include <philchess/uci/types.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * Measures how the lazy smp search scales with the number of threads:
+ * For every thread count, all positions are searched to a fixed depth from an empty table and
+ * the summed time to depth and nodes per second are reported, together with the speedup relative to the single threaded run.
+ *
+ * Usage: smp_scaling [depth=10] [max_threads=64] [hash_mb=64]
+**/
+
+using namespace philchess;
+using namespace std::string_view_literals;
+
+namespace
+{
+	constexpr std::string_view positions[]=
+	{
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"sv,
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"sv,
+		"r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP1BBPPP/R2QK2R w KQ - 0 9"sv,
+		"2r3k1/pp3ppp/4p3/3pP3/3P4/P4N2/1P3PPP/2R3K1 w - - 0 25"sv,
+		"8/5pk1/6p1/7p/P6P/6P1/5PK1/8 w - - 0 40"sv
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned depth=argc>1?std::atoi(argv[1]):10;
+	const int max_threads=argc>2?std::atoi(argv[2]):64;
+	const int hash_mb=argc>3?std::atoi(argv[3]):64;
+
+	std::cout<<"threads  time-to-depth(ms)  nodes         nps        speedup"<<std::endl;
+
+	double single_threaded_time=0;
+	for(int threads=1;threads<=max_threads;threads*=2)
+	{
+		engine::paulchen332 engine;
+		engine.set_option(std::integral_constant<std::size_t,0>{},hash_mb);
+		engine.set_option(std::integral_constant<std::size_t,1>{},threads);
+
+		engine::search_report report;
+		std::chrono::milliseconds total_time{0};
+
+		for(const auto fen: positions)
+		{
+			engine.reset();
+			engine.setup(fen);
+
+			uci::search_settings settings;
+			settings.depth=depth;
+
+			const std::atomic<bool> should_stop{false};
+
+			const auto start=std::chrono::steady_clock::now();
+			engine.search(engine::silent_controller{should_stop,{&report}},settings);
+			total_time+=std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-start);
+		}
+
+		const auto ms=std::max<long long>(total_time.count(),1);
+		if(threads==1)
+			single_threaded_time=ms;
+
+		std::cout<<std::setw(7)<<threads
+			<<std::setw(19)<<ms
+			<<std::setw(13)<<report.nodes
+			<<std::setw(11)<<report.nodes*1000/ms
+			<<std::setw(13)<<std::fixed<<std::setprecision(2)<<single_threaded_time/ms
+			<<std::endl;
+	}
+
+	return 0;
+}
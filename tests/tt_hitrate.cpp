@@ -0,0 +1,72 @@
+#include <philchess/chessboard.hpp>
+#include <philchess/default_search_control.hpp>
+
+#include <philchess/algorithm/alpha_beta_pruning.hpp>
+#include <philchess/algorithm/negamax.hpp>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+
+/**
+ * Transposition table hit rate and nodes to depth at a couple of fixed (small) hash sizes.
+ * Every position is searched from an empty table by plain iterative deepening, so that the numbers only depend on the table itself.
+ *
+ * Usage: tt_hitrate [depth=10]
+**/
+
+using namespace philchess;
+using namespace std::string_view_literals;
+
+namespace
+{
+	constexpr std::string_view positions[]=
+	{
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"sv,
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"sv,
+		"r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP1BBPPP/R2QK2R w KQ - 0 9"sv,
+		"2r3k1/pp3ppp/4p3/3pP3/3P4/P4N2/1P3PPP/2R3K1 w - - 0 25"sv,
+		"8/5pk1/6p1/7p/P6P/6P1/5PK1/8 w - - 0 40"sv,
+		"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"sv
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned depth=argc>1?std::atoi(argv[1]):10;
+
+	std::cout<<"hash(MB)  entries     probes       hits         hitrate  nodes"<<std::endl;
+	for(std::size_t hash_mb: {1,2,4,16})
+	{
+		default_search_control control;
+		control.resize_tt(hash_mb);
+
+		unsigned long long probes=0, hits=0, nodes=0;
+		for(const auto fen: positions)
+		{
+			chessboard board;
+			board.setup(fen);
+			control.reset_tt();
+
+			for(unsigned d=1;d<=depth;++d)
+			{
+				algorithm::negamax(board,control,algorithm::alpha_beta_pruning<int>{},[](){ return false; },d);
+				probes+=control.number_of_cache_probes();
+				hits+=control.number_of_cache_hits();
+				nodes+=control.number_of_statically_evaluated_nodes();
+				control.reset_stats();
+			}
+		}
+
+		std::cout<<std::setw(8)<<hash_mb
+			<<std::setw(10)<<control.number_of_tt_entries()
+			<<std::setw(13)<<probes
+			<<std::setw(13)<<hits
+			<<std::setw(9)<<std::fixed<<std::setprecision(3)<<static_cast<double>(hits)/probes
+			<<"  "<<nodes
+			<<std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,86 @@
+#include <philchess/transposition_table.hpp>
+#include <philchess/types.hpp>
+#include <philchess/zobrist.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <cstdint>
+
+/**
+ * Random probe latency of the transposition table, with normal and with large pages.
+ * Each probe depends on the result of the previous one, so they cannot overlap and the time per probe really is the latency
+ * of a random access into the table, including the TLB miss it usually causes.
+ *
+ * Usage: tt_latency [max_hash_mb=1024] [probes=20000000]
+**/
+
+using namespace philchess;
+
+namespace
+{
+	constexpr std::size_t number_of_keys=1<<22;
+
+	std::vector<zobrist> make_keys()
+	{
+		std::mt19937_64 rng{1729};
+		std::vector<zobrist> ret_val(number_of_keys);
+		for(auto& key:ret_val)
+		{
+			for(int i=0;i<8;++i)
+				key.update(static_cast<piece_type>(rng()%6),square{rng()%64},rng()%2?side::white:side::black);
+		}
+		return ret_val;
+	}
+
+	double measure_probe_latency(transposition_table& table, const std::vector<zobrist>& keys, unsigned long probes)
+	{
+		for(const auto key:keys)
+			table.store(key,0,score_type::exact,move{},1);
+
+		std::size_t idx=0;
+		const auto start=std::chrono::steady_clock::now();
+		for(unsigned long i=0;i<probes;++i)
+		{
+			const auto entry=table.probe(keys[idx],0);
+			idx=(idx*2862933555777941757ull+3037000493ull+(entry?entry->depth:0))%keys.size();
+		}
+		const auto elapsed=std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start);
+
+		return static_cast<double>(elapsed.count())/probes;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const std::size_t max_hash_mb=argc>1?std::atoi(argv[1]):1024;
+	const unsigned long probes=argc>2?std::atol(argv[2]):20000000;
+
+	const auto keys=make_keys();
+
+	std::cout<<"hash(MB)  normal pages(ns)  large pages(ns)  large pages in use"<<std::endl;
+	for(std::size_t hash_mb=16;hash_mb<=max_hash_mb;hash_mb*=4)
+	{
+		const auto normal_latency=[&]()
+		{
+			transposition_table normal{hash_mb,false};
+			return measure_probe_latency(normal,keys,probes);
+		}();
+
+		transposition_table large{hash_mb,true};
+		const auto large_latency=measure_probe_latency(large,keys,probes);
+
+		std::cout<<std::setw(8)<<hash_mb
+			<<std::fixed<<std::setprecision(1)
+			<<std::setw(18)<<normal_latency
+			<<std::setw(17)<<large_latency
+			<<std::setw(20)<<(large.large_pages_in_use()?"yes":"no")
+			<<std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,123 @@
+#include <philchess/transposition_table.hpp>
+#include <philchess/types.hpp>
+#include <philchess/zobrist.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <cstdint>
+
+/**
+ * Hammers a deliberately tiny transposition table from many threads at once. Every stored entry is a pure function of its key,
+ * so any hit whose content does not match its key is an entry torn by a concurrent write that slipped through validation.
+ *
+ * Usage: tt_stress [threads=16] [operations_per_thread=4000000] [hash_mb=1]
+**/
+
+using namespace philchess;
+
+namespace
+{
+	constexpr std::size_t number_of_keys=1<<20;
+
+	zobrist make_key(std::uint32_t id) noexcept
+	{
+		zobrist ret_val;
+		for(std::uint8_t bit=0;bit<20;++bit)
+		{
+			if(id&(1u<<bit))
+				ret_val.update(static_cast<piece_type>(bit%6),square{bit},side::white);
+			else
+				ret_val.update(static_cast<piece_type>(bit%6),square{bit+32},side::black);
+		}
+		return ret_val;
+	}
+
+	struct expected_t
+	{
+		int eval;
+		move m;
+		score_type type;
+		std::uint8_t depth;
+	};
+
+	expected_t expected_entry(zobrist key) noexcept
+	{
+		const auto v=key.value();
+		return
+		{
+			static_cast<std::int16_t>(v), //the table only keeps 16 bits of score
+			move{square{(v>>32)&0x3f},square{(v>>38)&0x3f}},
+			static_cast<score_type>((v>>44)%3),
+			static_cast<std::uint8_t>(v>>48)
+		};
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned number_of_threads=argc>1?std::atoi(argv[1]):16;
+	const unsigned long operations=argc>2?std::atol(argv[2]):4000000;
+	const std::size_t hash_mb=argc>3?std::atoi(argv[3]):1;
+
+	std::vector<zobrist> keys(number_of_keys);
+	for(std::uint32_t i=0;i<number_of_keys;++i)
+		keys[i]=make_key(i);
+
+	transposition_table table{hash_mb};
+
+	std::atomic<unsigned long> stores{0}, probes{0}, hits{0}, corrupted{0};
+
+	std::vector<std::thread> threads;
+	for(unsigned id=0;id<number_of_threads;++id)
+	{
+		threads.emplace_back([&,id]()
+		{
+			std::mt19937_64 rng{id};
+			unsigned long local_stores=0, local_probes=0, local_hits=0, local_corrupted=0;
+
+			for(unsigned long i=0;i<operations;++i)
+			{
+				const auto key=keys[rng()%number_of_keys];
+				const auto expected=expected_entry(key);
+
+				if(rng()&1)
+				{
+					table.store(key,expected.eval,expected.type,expected.m,expected.depth);
+					++local_stores;
+				}
+				else
+				{
+					++local_probes;
+					const auto entry=table.probe(key,0);
+					if(entry)
+					{
+						++local_hits;
+						if(entry->eval!=expected.eval || entry->best_or_refutation_move!=expected.m || entry->type!=expected.type || entry->depth!=expected.depth)
+							++local_corrupted;
+					}
+				}
+			}
+
+			stores+=local_stores;
+			probes+=local_probes;
+			hits+=local_hits;
+			corrupted+=local_corrupted;
+		});
+	}
+
+	for(auto& thd:threads)
+		thd.join();
+
+	std::cout<<"threads:   "<<number_of_threads<<'\n';
+	std::cout<<"stores:    "<<stores<<'\n';
+	std::cout<<"probes:    "<<probes<<'\n';
+	std::cout<<"hits:      "<<hits<<'\n';
+	std::cout<<"corrupted: "<<corrupted<<std::endl;
+
+	return corrupted==0?EXIT_SUCCESS:EXIT_FAILURE;
+}
@@ -138,7 +138,7 @@ namespace turochamp
 	
 	struct occupancy_pair
 	{
-		bitboard::all all;
+		bitboard::rank all;
 		side_map<bitboard::rank> per_side;
 	};
 	
@@ -457,7 +457,7 @@ namespace turochamp
 			}
 			
 			const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
-			control.io.report_pv({full_depth,0},elapsed,0, static_cast<int>(best_score.material*100+best_score.position), std::optional<int>{}, std::array{best_move});
+			control.io.report_pv({full_depth,0},elapsed,0, std::nullopt, static_cast<int>(best_score.material*100+best_score.position), std::optional<int>{}, std::array{best_move});
 			control.io.debug_message("material: ",best_score.material);
 			control.io.debug_message("position: ",best_score.position);
 			
@@ -0,0 +1,80 @@
+#include "../src/engine/paulchen332.hpp"
+#include "../src/engine/silent_controller.hpp"
+
+#include <philchess/uci/types.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * How much the cutoff on upcoming repetitions saves where nobody can make progress:
+ * Searches a couple of fortresses and locked positions to a fixed depth, once with the detection and once without,
+ * and reports the nodes and time it took for each.
+ *
+ * Usage: upcoming_repetition [depth=16] [hash_mb=64]
+**/
+
+using namespace philchess;
+using namespace std::string_view_literals;
+
+namespace
+{
+	constexpr std::string_view positions[]=
+	{
+		"8/8/1k6/p1p1p1p1/P1P1P1P1/8/3K4/8 w - - 0 1"sv, //nothing but king moves
+		"8/4kb2/8/1p1p1p2/1P1P1P2/8/3BK3/8 w - - 0 1"sv, //locked pawns, opposite bishops
+		"3k4/R7/8/3PK3/8/8/8/2r5 b - - 0 1"sv, //rook endgame, black checks from behind
+		"7k/8/6KP/8/8/8/8/5B2 w - - 0 1"sv, //rook pawn and the wrong bishop
+		"8/8/2k5/p1p1p1p1/P1P1P1P1/2K5/8/5B2 w - - 0 1"sv, //a bishop up, with nothing to attack
+		"6k1/5p1p/6p1/8/8/6P1/r4P1P/3R2K1 w - - 0 1"sv
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned depth=argc>1?std::atoi(argv[1]):16;
+	const int hash_mb=argc>2?std::atoi(argv[2]):64;
+
+	for(const auto detection: {false, true})
+	{
+		search_parameters parameters;
+		parameters.upcoming_repetition_detection=detection;
+
+		engine::paulchen332 engine{parameters};
+		engine.set_option(std::integral_constant<std::size_t,0>{},hash_mb);
+
+		std::cout<<"upcoming repetition detection "<<(detection?"on":"off")<<'\n';
+
+		unsigned long long total_nodes=0;
+		std::chrono::milliseconds total_time{0};
+		for(const auto fen: positions)
+		{
+			engine.reset();
+			engine.setup(fen);
+
+			uci::search_settings settings;
+			settings.depth=depth;
+
+			const std::atomic<bool> should_stop{false};
+			engine::search_report report;
+
+			const auto start=std::chrono::steady_clock::now();
+			engine.search(engine::silent_controller{should_stop,{&report}},settings);
+			const auto time=std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-start);
+			const auto nodes=report.nodes;
+
+			total_nodes+=nodes;
+			total_time+=time;
+			std::cout<<std::setw(50)<<std::left<<fen<<std::setw(12)<<std::right<<nodes<<" nodes in "<<std::setw(6)<<time.count()<<"ms\n";
+		}
+		std::cout<<std::setw(50)<<std::left<<"Total"<<std::setw(12)<<std::right<<total_nodes<<" nodes in "<<std::setw(6)<<total_time.count()<<"ms\n"<<std::endl;
+	}
+
+	return 0;
+}
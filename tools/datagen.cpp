@@ -0,0 +1,235 @@
+#include "../src/engine/paulchen332.hpp"
+#include "../src/engine/silent_controller.hpp"
+
+#include <philchess/chessboard.hpp>
+#include <philchess/default_search_control.hpp>
+#include <philchess/position_record.hpp>
+
+#include <philchess/uci/types.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Generates positions to tune on: plays games of the engine against itself, every move searched to a fixed number of nodes("go nodes"), from openings of a few random moves,
+ * and appends the quiet positions of every finished game to the output as position records, with the score of their search and the result of the game.
+ * Quiet meaning: not in check, not about to be mated and the best move found neither captures nor promotes, so that the static evaluation has a chance to agree.
+ *
+ * Every thread plays games of its own with an engine of its own, so its own search control and transposition table, and nothing but the output is shared.
+ * Games are adjudicated once both sides agree that one of them is winning by a lot, openings that are lost already are thrown away, as are games too long to finish.
+ * The file is appended to, so several runs(with different seeds!) can go into the same one.
+ *
+ * Usage: datagen output_file [games=1000] [nodes=5000] [threads=all] [seed=random] [hash_mb=16]
+**/
+
+using namespace philchess;
+
+namespace
+{
+	constexpr unsigned min_opening_plies=8;
+	constexpr int max_opening_score=300;
+	constexpr int adjudication_score=1500;
+	constexpr unsigned adjudication_plies=4;
+	constexpr unsigned max_game_plies=500;
+
+	struct statistics
+	{
+		std::atomic<unsigned> games_started{0}, games_finished{0}, games_discarded{0};
+		std::atomic<unsigned long> positions{0};
+		side_map<std::atomic<unsigned>> wins{};
+		std::atomic<unsigned> draws{0};
+	};
+
+	class generator
+	{
+		public:
+		generator(unsigned games, std::uint64_t nodes, int hash_mb, std::uint32_t seed, position_record_writer& out, std::mutex& out_mutex, statistics& stats):
+			games_{games},
+			out_{out},
+			out_mutex_{out_mutex},
+			stats_{stats},
+			rng_{seed}
+		{
+			engine_.set_option(std::integral_constant<std::size_t,0>{},hash_mb);
+			settings_.nodes=nodes;
+		}
+
+		void run()
+		{
+			while(stats_.games_started++<games_)
+			{
+				while(!play_game())
+					++stats_.games_discarded;
+			}
+		}
+
+		private:
+		//false if the game was thrown away
+		bool play_game()
+		{
+			chessboard board;
+			board.setup("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+			engine_.reset();
+
+			//one more every now and then, so that black gets to be the first to move from them just as often
+			const unsigned opening_plies=min_opening_plies+rng_()%2;
+			for(unsigned ply=0;ply<opening_plies;++ply)
+			{
+				const auto moves=board.list_moves();
+				if(moves.empty())
+					return false;
+				const auto m=moves[rng_()%moves.size()];
+				board.do_move(m);
+				engine_.do_move(m);
+			}
+
+			records_.clear();
+			unsigned winning_plies=0;
+			int last_white_score=0;
+			for(unsigned ply=0;ply<max_game_plies;++ply)
+			{
+				const auto moves=board.list_moves();
+				if(moves.empty())
+					return finish_game(board.is_in_check()?(board.side_to_move()==side::white?game_result::black_wins:game_result::white_wins):game_result::draw);
+				if(board.is_rule_draw() || default_search_control::is_insufficient_material(board))
+					return finish_game(game_result::draw);
+
+				engine::search_report report;
+				const auto m=engine_.search(engine::silent_controller{should_stop_,{&report}},settings_);
+				const auto score=report.score;
+				const auto white_score=board.side_to_move()==side::white?score:-score;
+
+				if(ply==0 && std::abs(score)>max_opening_score)
+					return false;
+
+				const bool is_noisy=m.type()==move_type::promotion || m.type()==move_type::en_passant || board.piece_type_at(m.to())!=piece_type::none;
+				if(!report.mate_distance && !is_noisy && !board.is_in_check())
+					records_.push_back(make_position_record(board,static_cast<std::int16_t>(std::clamp(white_score,-32767,32767))));
+
+				//plies in a row, so both sides have to agree on it
+				if(std::abs(white_score)<adjudication_score)
+					winning_plies=0;
+				else if(winning_plies>0 && (white_score>0)!=(last_white_score>0))
+					winning_plies=1;
+				else
+					++winning_plies;
+				last_white_score=white_score;
+				if(winning_plies>=adjudication_plies)
+					return finish_game(white_score>0?game_result::white_wins:game_result::black_wins);
+
+				board.do_move(m);
+				engine_.do_move(m);
+			}
+
+			return false;
+		}
+
+		bool finish_game(game_result result)
+		{
+			for(auto& record: records_)
+				record.result=result;
+
+			{
+				std::lock_guard<std::mutex> lock{out_mutex_};
+				out_.write(records_.data(),records_.size());
+			}
+
+			++stats_.games_finished;
+			stats_.positions+=records_.size();
+			if(result==game_result::draw)
+				++stats_.draws;
+			else
+				++stats_.wins[result==game_result::white_wins?side::white:side::black];
+			return true;
+		}
+
+		unsigned games_;
+		position_record_writer& out_;
+		std::mutex& out_mutex_;
+		statistics& stats_;
+
+		engine::paulchen332 engine_;
+		uci::search_settings settings_;
+		const std::atomic<bool> should_stop_{false};
+		std::mt19937 rng_;
+		std::vector<position_record> records_;
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc<2)
+	{
+		std::cout<<"Usage: "<<argv[0]<<" output_file [games=1000] [nodes=5000] [threads=all] [seed=random] [hash_mb=16]"<<std::endl;
+		return 1;
+	}
+
+	const unsigned games=argc>2?std::stoul(argv[2]):1000;
+	const std::uint64_t nodes=argc>3?std::stoull(argv[3]):5000;
+	const unsigned thread_count=argc>4?std::stoul(argv[4]):std::max(1u,std::thread::hardware_concurrency());
+	const std::uint32_t seed=argc>5?std::stoul(argv[5]):std::random_device{}();
+	const int hash_mb=argc>6?std::stoi(argv[6]):16;
+
+	position_record_writer out{argv[1],true};
+	if(!out)
+	{
+		std::cout<<"Could not open "<<argv[1]<<" ;_;"<<std::endl;
+		return 1;
+	}
+	std::mutex out_mutex;
+
+	std::cout<<games<<" games at "<<nodes<<" nodes per move, "<<thread_count<<" threads, seed "<<seed<<std::endl;
+
+	statistics stats;
+	std::vector<std::unique_ptr<generator>> generators;
+	for(unsigned id=0;id<thread_count;++id)
+		generators.push_back(std::make_unique<generator>(games,nodes,hash_mb,seed+id,out,out_mutex,stats));
+
+	const auto start_time=std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for(auto& gen: generators)
+		threads.emplace_back([&gen](){ gen->run(); });
+
+	const auto report=[&]()
+	{
+		const auto seconds=std::max(std::chrono::duration<double>(std::chrono::steady_clock::now()-start_time).count(),0.001);
+		std::cout<<std::fixed<<std::setprecision(1)
+			<<stats.games_finished<<" games(+"<<stats.wins[side::white]<<" ="<<stats.draws<<" -"<<stats.wins[side::black]<<", "<<stats.games_discarded<<" discarded), "
+			<<stats.positions<<" positions in "<<seconds<<"s: "
+			<<stats.games_finished/seconds<<" games/s, "<<stats.positions/seconds<<" positions/s"<<std::endl;
+	};
+
+	auto next_report=start_time+std::chrono::seconds{10};
+	while(stats.games_finished<games)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds{100});
+		if(std::chrono::steady_clock::now()>=next_report)
+		{
+			report();
+			next_report+=std::chrono::seconds{10};
+		}
+	}
+
+	for(auto& thd: threads)
+		thd.join();
+	report();
+
+	if(!out.flush())
+	{
+		std::cout<<"Could not write to "<<argv[1]<<" ;_;"<<std::endl;
+		return 1;
+	}
+}
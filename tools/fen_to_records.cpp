@@ -0,0 +1,61 @@
+#include <philchess/position_record.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+/**
+ * Converts FEN/EPD lines, as parse_labelled_position understands them, into a file of position records, for the tuner and whatever else wants to read lots of positions quickly.
+ * Lines that are no position are skipped, and counted.
+ *
+ * Usage: fen_to_records input_file output_file [append=0]
+**/
+
+using namespace philchess;
+
+int main(int argc, char* argv[])
+{
+	if(argc<3)
+	{
+		std::cout<<"Usage: "<<argv[0]<<" input_file output_file [append=0]"<<std::endl;
+		return 1;
+	}
+
+	std::ifstream in{argv[1]};
+	if(!in)
+	{
+		std::cout<<"Could not open "<<argv[1]<<" ;_;"<<std::endl;
+		return 1;
+	}
+
+	const bool append=argc>3 && std::stoi(argv[3])!=0;
+	position_record_writer out{argv[2],append};
+
+	unsigned long written=0, skipped=0, without_result=0, without_score=0;
+	std::string line;
+	while(std::getline(in,line))
+	{
+		const auto record=parse_labelled_position(line);
+		if(!record)
+		{
+			++skipped;
+			continue;
+		}
+
+		without_result+=record->result==game_result::unknown?1:0;
+		without_score+=record->score==position_record::no_score?1:0;
+		if(!out.write(*record))
+		{
+			std::cout<<"Could not write to "<<argv[2]<<" ;_;"<<std::endl;
+			return 1;
+		}
+		++written;
+	}
+
+	if(!out.flush())
+	{
+		std::cout<<"Could not write to "<<argv[2]<<" ;_;"<<std::endl;
+		return 1;
+	}
+	std::cout<<written<<" positions written("<<without_result<<" without result, "<<without_score<<" without score), "<<skipped<<" lines skipped"<<std::endl;
+}
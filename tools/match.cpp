@@ -0,0 +1,503 @@
+#include "../src/engine/paulchen332.hpp"
+#include "../src/engine/silent_controller.hpp"
+
+#include <philchess/chessboard.hpp>
+#include <philchess/default_search_control.hpp>
+#include <philchess/position_record.hpp>
+
+#include <philchess/uci/types.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Plays the engine against itself with different search_parameters, engine A against engine B, on as many threads as there are cores, until an SPRT decides
+ * whether A is better than B by elo1 rather than by elo0(logistic Elo, as fishtest has them), or the maximum number of games is reached.
+ *
+ * Every opening is played twice, with either engine as white, and the pairs are what is counted(pentanomial, so that lopsided openings do not make it look more certain than it is).
+ * The openings come from a book, one FEN or EPD per line, in random order, or are a few random moves from the start position if there is none.
+ * Moves are searched either to a fixed number of nodes or on a clock of base seconds plus increment, which loses on time if it runs out. Nodes are the
+ * better choice with more threads than cores, or anything else running, as the clocks keep running while a thread is waiting for its turn.
+ * Games are adjudicated once both engines agree that one side is winning by a lot, or that nothing is going on anymore late in the game.
+ *
+ * Everything is given as name=value. Parameters of the engines are prefixed with a. or b., the rest are:
+ *   games=100000 threads=all nodes=5000 tc=(base seconds+increment seconds, instead of nodes) book=(file) hash=16 seed=random elo0=0 elo1=5 alpha=0.05 beta=0.05
+ * The parameters are qs_delta_margin, upcoming_repetition_detection(0 or 1) and, as comma separated lists of all their values, nullmove_depth, futility_margins,
+ * reverse_futility_margins, razor_margins and reverse_razor_margins.
+ *
+ * Usage: match [a.parameter=value]... [b.parameter=value]... [setting=value]...
+ * e.g.   match a.qs_delta_margin=1200 tc=10+0.1 elo0=0 elo1=10
+**/
+
+using namespace philchess;
+
+namespace
+{
+	constexpr unsigned random_opening_plies=8;
+	constexpr int adjudication_score=1500;
+	constexpr unsigned adjudication_plies=4;
+	constexpr unsigned draw_adjudication_ply=80;
+	constexpr int draw_adjudication_score=10;
+	constexpr unsigned draw_adjudication_plies=8;
+	constexpr unsigned max_game_plies=600;
+
+	struct settings_t
+	{
+		std::array<search_parameters,2> parameters{}; //A, B
+		unsigned long max_games=100000;
+		unsigned threads=std::max(1u,std::thread::hardware_concurrency());
+		std::uint64_t nodes=5000;
+		std::optional<std::chrono::milliseconds> base_time;
+		std::chrono::milliseconds increment{0};
+		std::string book;
+		int hash_mb=16;
+		std::uint32_t seed=std::random_device{}();
+		double elo0=0, elo1=5, alpha=0.05, beta=0.05;
+	};
+
+	template <typename T, std::size_t N>
+	bool parse_list(const std::string& value, std::array<T,N>& target)
+	{
+		std::array<T,N> parsed;
+		std::istringstream in{value};
+		std::string item;
+		std::size_t count=0;
+		while(std::getline(in,item,','))
+		{
+			if(count==N)
+				return false;
+			parsed[count++]=static_cast<T>(std::stoi(item));
+		}
+		if(count!=N)
+			return false;
+		target=parsed;
+		return true;
+	}
+
+	bool set_parameter(search_parameters& params, std::string_view name, const std::string& value)
+	{
+		if(name=="qs_delta_margin")
+			params.qs_delta_margin=std::stoi(value);
+		else if(name=="upcoming_repetition_detection")
+			params.upcoming_repetition_detection=std::stoi(value)!=0;
+		else if(name=="nullmove_depth")
+			return parse_list(value,params.nullmove_depth);
+		else if(name=="futility_margins")
+			return parse_list(value,params.futility_margins);
+		else if(name=="reverse_futility_margins")
+			return parse_list(value,params.reverse_futility_margins);
+		else if(name=="razor_margins")
+			return parse_list(value,params.razor_margins);
+		else if(name=="reverse_razor_margins")
+			return parse_list(value,params.reverse_razor_margins);
+		else
+			return false;
+		return true;
+	}
+
+	bool set_setting(settings_t& settings, std::string_view name, const std::string& value)
+	{
+		if(name.substr(0,2)=="a.")
+			return set_parameter(settings.parameters[0],name.substr(2),value);
+		if(name.substr(0,2)=="b.")
+			return set_parameter(settings.parameters[1],name.substr(2),value);
+
+		if(name=="games")
+			settings.max_games=std::stoul(value);
+		else if(name=="threads")
+			settings.threads=std::max(1ul,std::stoul(value));
+		else if(name=="nodes")
+			settings.nodes=std::stoull(value);
+		else if(name=="tc")
+		{
+			const auto plus=value.find('+');
+			const auto to_ms=[](const std::string& seconds){ return std::chrono::milliseconds{static_cast<long>(std::stod(seconds)*1000)}; };
+			settings.base_time=to_ms(value.substr(0,plus));
+			settings.increment=plus==std::string::npos?std::chrono::milliseconds{0}:to_ms(value.substr(plus+1));
+		}
+		else if(name=="book")
+			settings.book=value;
+		else if(name=="hash")
+			settings.hash_mb=std::stoi(value);
+		else if(name=="seed")
+			settings.seed=std::stoul(value);
+		else if(name=="elo0")
+			settings.elo0=std::stod(value);
+		else if(name=="elo1")
+			settings.elo1=std::stod(value);
+		else if(name=="alpha")
+			settings.alpha=std::stod(value);
+		else if(name=="beta")
+			settings.beta=std::stod(value);
+		else
+			return false;
+		return true;
+	}
+
+	std::vector<std::string> read_book(const std::string& path, std::uint32_t seed)
+	{
+		std::vector<std::string> ret_val;
+		std::ifstream in{path};
+		std::string line;
+		while(std::getline(in,line))
+		{
+			const auto record=parse_labelled_position(line);
+			if(!record)
+				continue;
+
+			chessboard board;
+			board.setup(*record);
+			if(!board.list_moves().empty())
+				ret_val.push_back(board.fen());
+		}
+
+		std::mt19937 rng{seed};
+		std::shuffle(std::begin(ret_val),std::end(ret_val),rng);
+		return ret_val;
+	}
+
+	std::string random_opening(std::mt19937& rng)
+	{
+		for(;;)
+		{
+			chessboard board;
+			board.setup("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+
+			unsigned ply=0;
+			for(;ply<random_opening_plies;++ply)
+			{
+				const auto moves=board.list_moves();
+				if(moves.empty())
+					break;
+				board.do_move(moves[rng()%moves.size()]);
+			}
+
+			if(ply==random_opening_plies && !board.list_moves().empty())
+				return board.fen();
+		}
+	}
+
+	double expected_score(double elo)
+	{
+		return 1/(1+std::pow(10.0,-elo/400));
+	}
+
+	double elo_of(double score)
+	{
+		score=std::clamp(score,1e-6,1-1e-6);
+		return 400*std::log10(score/(1-score));
+	}
+
+	//results of the pairs of games, from the point of view of A: 0, 1/2, 1, 3/2 and 2 points
+	struct pair_statistics
+	{
+		std::array<unsigned long,5> pentanomial{};
+		unsigned long wins=0, draws=0, losses=0;
+
+		unsigned long pairs() const noexcept
+		{
+			unsigned long ret_val=0;
+			for(auto count: pentanomial)
+				ret_val+=count;
+			return ret_val;
+		}
+
+		//mean and variance of the score per game, with the pairs as samples
+		std::pair<double,double> score_distribution() const noexcept
+		{
+			const auto n=static_cast<double>(pairs());
+			double mean=0, variance=0;
+			for(std::size_t i=0;i<5;++i)
+				mean+=pentanomial[i]*(i/4.0)/n;
+			for(std::size_t i=0;i<5;++i)
+				variance+=pentanomial[i]*(i/4.0-mean)*(i/4.0-mean)/n;
+			return {mean,variance};
+		}
+
+		//the generalized SPRT of fishtest, with a normal approximation of the pair scores
+		double llr(double elo0, double elo1) const noexcept
+		{
+			if(pairs()<2)
+				return 0;
+			const auto [mean,variance]=score_distribution();
+			if(variance<=0)
+				return 0;
+			const auto s0=expected_score(elo0), s1=expected_score(elo1);
+			return pairs()*(s1-s0)*(2*mean-s0-s1)/(2*variance);
+		}
+	};
+
+	class match
+	{
+		public:
+		explicit match(const settings_t& settings):
+			settings_{settings},
+			lower_bound_{std::log(settings.beta/(1-settings.alpha))},
+			upper_bound_{std::log((1-settings.beta)/settings.alpha)}
+		{
+			if(!settings.book.empty())
+				book_=read_book(settings.book,settings.seed);
+		}
+
+		bool has_openings() const noexcept { return settings_.book.empty() || !book_.empty(); }
+
+		void run()
+		{
+			std::vector<std::thread> threads;
+			for(unsigned id=0;id<settings_.threads;++id)
+				threads.emplace_back([this,id](){ play_pairs(id); });
+
+			auto next_report=std::chrono::steady_clock::now()+std::chrono::seconds{10};
+			while(running_threads_>0)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds{100});
+				if(std::chrono::steady_clock::now()>=next_report)
+				{
+					report();
+					next_report+=std::chrono::seconds{10};
+				}
+			}
+
+			for(auto& thd: threads)
+				thd.join();
+			report();
+
+			const auto llr=stats_.llr(settings_.elo0,settings_.elo1);
+			if(llr>=upper_bound_)
+				std::cout<<"H1 accepted: A is stronger by "<<settings_.elo1<<" Elo rather than "<<settings_.elo0<<std::endl;
+			else if(llr<=lower_bound_)
+				std::cout<<"H0 accepted: A is not stronger by "<<settings_.elo1<<" Elo, rather "<<settings_.elo0<<" at best"<<std::endl;
+			else
+				std::cout<<"No decision after "<<2*stats_.pairs()<<" games ;_;"<<std::endl;
+		}
+
+		private:
+		using engine_pair=std::array<std::unique_ptr<engine::paulchen332>,2>;
+
+		void play_pairs(unsigned id)
+		{
+			engine_pair engines{
+				std::make_unique<engine::paulchen332>(settings_.parameters[0]),
+				std::make_unique<engine::paulchen332>(settings_.parameters[1])};
+			for(auto& engine: engines)
+				engine->set_option(std::integral_constant<std::size_t,0>{},settings_.hash_mb);
+
+			std::mt19937 rng{settings_.seed+id+1};
+			for(;;)
+			{
+				const auto pair=next_pair_++;
+				if(stop_ || 2*pair>=settings_.max_games)
+					break;
+
+				const auto opening=book_.empty()?random_opening(rng):book_[pair%book_.size()];
+				const auto a_as_white=play_game(engines,opening,true);
+				const auto a_as_black=play_game(engines,opening,false);
+				if(!a_as_white || !a_as_black)
+					break;
+
+				record_pair(*a_as_white,*a_as_black);
+			}
+			--running_threads_;
+		}
+
+		//points for A, times two, so that a draw is 1. nullopt if the match was stopped in between
+		std::optional<unsigned> play_game(engine_pair& engines, const std::string& opening, bool a_is_white)
+		{
+			chessboard board;
+			board.setup(opening);
+			for(auto& engine: engines)
+			{
+				engine->reset();
+				engine->setup(opening);
+			}
+
+			side_map<std::chrono::milliseconds> remaining_time{{{settings_.base_time.value_or(std::chrono::milliseconds{0}),settings_.base_time.value_or(std::chrono::milliseconds{0})}}};
+			const auto points_for_a=[a_is_white](game_result result) -> unsigned
+			{
+				if(result==game_result::draw)
+					return 1;
+				return (result==game_result::white_wins)==a_is_white?2:0;
+			};
+			const auto loss_for=[](side s){ return s==side::white?game_result::black_wins:game_result::white_wins; };
+
+			unsigned winning_plies=0, drawn_plies=0;
+			int last_white_score=0;
+			for(unsigned ply=0;ply<max_game_plies;++ply)
+			{
+				const auto moves=board.list_moves();
+				if(moves.empty())
+					return points_for_a(board.is_in_check()?loss_for(board.side_to_move()):game_result::draw);
+				if(board.is_rule_draw() || default_search_control::is_insufficient_material(board))
+					return points_for_a(game_result::draw);
+				if(stop_)
+					return std::nullopt;
+
+				const auto to_move=board.side_to_move();
+				auto& engine=*engines[(to_move==side::white)==a_is_white?0:1];
+
+				uci::search_settings search;
+				if(settings_.base_time)
+				{
+					search.remaining_time[side::white]=remaining_time[side::white];
+					search.remaining_time[side::black]=remaining_time[side::black];
+					search.increment[side::white]=search.increment[side::black]=settings_.increment;
+				}
+				else
+					search.nodes=settings_.nodes;
+
+				engine::search_report report;
+				const auto start_time=std::chrono::steady_clock::now();
+				const auto m=engine.search(engine::silent_controller{stop_,{&report}},search);
+				const auto score=report.score;
+				if(stop_)
+					return std::nullopt;
+
+				if(settings_.base_time)
+				{
+					remaining_time[to_move]-=std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-start_time);
+					if(remaining_time[to_move].count()<0)
+					{
+						++time_losses_;
+						return points_for_a(loss_for(to_move));
+					}
+					remaining_time[to_move]+=settings_.increment;
+				}
+
+				if(!board.is_legal(m))
+				{
+					std::cerr<<"illegal move "<<m<<" in "<<board.fen()<<" ;_;"<<std::endl;
+					return points_for_a(loss_for(to_move));
+				}
+
+				//plies in a row, so both engines have to agree on it
+				const auto white_score=to_move==side::white?score:-score;
+				if(std::abs(white_score)<adjudication_score)
+					winning_plies=0;
+				else if(winning_plies>0 && (white_score>0)!=(last_white_score>0))
+					winning_plies=1;
+				else
+					++winning_plies;
+				last_white_score=white_score;
+				if(winning_plies>=adjudication_plies)
+					return points_for_a(white_score>0?game_result::white_wins:game_result::black_wins);
+
+				drawn_plies=std::abs(white_score)<=draw_adjudication_score?drawn_plies+1:0;
+				if(ply>=draw_adjudication_ply && drawn_plies>=draw_adjudication_plies)
+					return points_for_a(game_result::draw);
+
+				board.do_move(m);
+				for(auto& e: engines)
+					e->do_move(m);
+			}
+
+			return points_for_a(game_result::draw);
+		}
+
+		void record_pair(unsigned a_as_white, unsigned a_as_black)
+		{
+			std::lock_guard<std::mutex> lock{stats_mutex_};
+			++stats_.pentanomial[a_as_white+a_as_black];
+			for(auto points: {a_as_white,a_as_black})
+			{
+				stats_.wins+=points==2?1:0;
+				stats_.draws+=points==1?1:0;
+				stats_.losses+=points==0?1:0;
+			}
+
+			const auto llr=stats_.llr(settings_.elo0,settings_.elo1);
+			if(llr>=upper_bound_ || llr<=lower_bound_)
+				stop_=true;
+		}
+
+		void report()
+		{
+			std::lock_guard<std::mutex> lock{stats_mutex_};
+			const auto pairs=stats_.pairs();
+			if(pairs==0)
+				return;
+
+			const auto [mean,variance]=stats_.score_distribution();
+			const auto error=1.959964*std::sqrt(variance/pairs); //95%
+			const auto elo=elo_of(mean);
+
+			std::cout<<std::fixed<<std::setprecision(2)
+				<<"Games "<<2*pairs<<": +"<<stats_.wins<<" ="<<stats_.draws<<" -"<<stats_.losses<<" ("<<time_losses_<<" on time)"
+				<<", pairs "<<stats_.pentanomial[0]<<' '<<stats_.pentanomial[1]<<' '<<stats_.pentanomial[2]<<' '<<stats_.pentanomial[3]<<' '<<stats_.pentanomial[4]
+				<<", Elo "<<elo<<" +- "<<(elo_of(mean+error)-elo_of(mean-error))/2
+				<<", LLR "<<stats_.llr(settings_.elo0,settings_.elo1)<<" ["<<lower_bound_<<", "<<upper_bound_<<"] ["<<settings_.elo0<<", "<<settings_.elo1<<"]"<<std::endl;
+		}
+
+		const settings_t settings_;
+		const double lower_bound_, upper_bound_;
+		std::vector<std::string> book_;
+
+		std::atomic<bool> stop_{false};
+		std::atomic<unsigned long> next_pair_{0};
+		std::atomic<unsigned> running_threads_{settings_.threads};
+		std::atomic<unsigned long> time_losses_{0};
+
+		std::mutex stats_mutex_;
+		pair_statistics stats_;
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	settings_t settings;
+	for(int i=1;i<argc;++i)
+	{
+		const std::string argument{argv[i]};
+		const auto equals=argument.find('=');
+
+		bool valid=equals!=std::string::npos;
+		try
+		{
+			valid=valid && set_setting(settings,std::string_view{argument}.substr(0,equals),argument.substr(equals+1));
+		}
+		catch(const std::exception&)
+		{
+			valid=false;
+		}
+
+		if(!valid)
+		{
+			std::cout<<"Cannot make sense of "<<argument<<" ;_;\n";
+			std::cout<<"Usage: "<<argv[0]<<" [a.parameter=value]... [b.parameter=value]... [setting=value]..., see tools/match.cpp for what there is"<<std::endl;
+			return 1;
+		}
+	}
+
+	match m{settings};
+	if(!m.has_openings())
+	{
+		std::cout<<"No positions in "<<settings.book<<" ;_;"<<std::endl;
+		return 1;
+	}
+
+	std::cout<<"up to "<<settings.max_games<<" games, ";
+	if(settings.base_time)
+		std::cout<<settings.base_time->count()/1000.0<<"s+"<<settings.increment.count()/1000.0<<"s per game";
+	else
+		std::cout<<settings.nodes<<" nodes per move";
+	std::cout<<", "<<settings.threads<<" threads, seed "<<settings.seed<<std::endl;
+
+	m.run();
+}
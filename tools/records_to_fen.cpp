@@ -0,0 +1,45 @@
+#include <philchess/position_record.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+/**
+ * Writes a file of position records out as text, one FEN per line, followed by the result as c9 and the score as ce, if known. The other way round from fen_to_records.
+ * Records that are no position at all are skipped, and counted.
+ *
+ * Usage: records_to_fen input_file [first=0] [count=all]
+**/
+
+using namespace philchess;
+
+int main(int argc, char* argv[])
+{
+	if(argc<2)
+	{
+		std::cout<<"Usage: "<<argv[0]<<" input_file [first=0] [count=all]"<<std::endl;
+		return 1;
+	}
+
+	const position_record_file records{argv[1]};
+	if(!records.is_open())
+	{
+		std::cerr<<"Could not read "<<argv[1]<<", or it is not a file of position records ;_;"<<std::endl;
+		return 1;
+	}
+
+	const std::size_t first=std::min<std::size_t>(argc>2?std::stoull(argv[2]):0,records.size());
+	const std::size_t count=std::min<std::size_t>(argc>3?std::stoull(argv[3]):records.size(),records.size()-first);
+
+	std::size_t invalid=0;
+	for(auto it=records.begin()+first;it!=records.begin()+first+count;++it)
+	{
+		if(it->is_valid())
+			std::cout<<format_labelled_position(*it)<<'\n';
+		else
+			++invalid;
+	}
+	
+	if(invalid>0)
+		std::cerr<<"Skipped "<<invalid<<" invalid records ;_;"<<std::endl;
+}
@@ -0,0 +1,542 @@
+#include <philchess/chessboard.hpp>
+#include <philchess/position_record.hpp>
+
+#include <philchess/eval/default_evaluation.hpp>
+#include <philchess/eval/evaluation_parameters.hpp>
+#include <philchess/eval/pawn_hash.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Texel style tuning of the weights of default_evaluation: finds the parameters for which the sigmoid of the static evaluation best predicts the results
+ * of the games a set of positions was taken from, by simple coordinate descent, one step up or down per parameter, for as long as that still helps.
+ * Every try evaluates all positions again, split up between all cores. That is slow, but needs nothing more from the evaluation than to be handed different parameters.
+ *
+ * The positions are either a file of position records(ending in .bin, see tools/fen_to_records), which is mapped and used as it is, or read one per line, FEN or EPD followed by the result,
+ * as parse_labelled_position understands them. Those without a result are ignored. They had better be quiet, as there is no search here.
+ *
+ * After every iteration, the parameters are written to the output directory as the files in src/eval they come from(evaluation_parameters.cpp, king_safety.cpp, mobility.cpp, phase.cpp
+ * and piece_square_table.cpp), ready to be copied over. With 0 iterations, those are exactly the ones compiled in.
+ *
+ * Usage: tune positions_file [iterations=100] [output_directory=.] [threads=all]
+**/
+
+using namespace philchess;
+
+namespace
+{
+	//either read from text or mapped from a file of records, which are simply used as they are
+	struct labelled_positions
+	{
+		std::unique_ptr<position_record_file> file;
+		std::vector<position_record> parsed;
+
+		const position_record* records=nullptr;
+		std::size_t size=0, labelled=0;
+	};
+
+	labelled_positions read_positions(const std::string& path)
+	{
+		labelled_positions ret_val;
+
+		if(std::filesystem::path{path}.extension()==".bin")
+		{
+			ret_val.file=std::make_unique<position_record_file>(path);
+			ret_val.records=ret_val.file->begin();
+			ret_val.size=ret_val.file->size();
+			
+			//anything can be in a file, a board set up from garbage is undefined behaviour. if there is any, the good ones are copied instead of used as they are
+			const auto invalid=std::count_if(ret_val.file->begin(),ret_val.file->end(),[](const auto& record){ return !record.is_valid(); });
+			if(invalid>0)
+			{
+				std::cout<<"Skipping "<<invalid<<" invalid records in "<<path<<std::endl;
+				std::copy_if(ret_val.file->begin(),ret_val.file->end(),std::back_inserter(ret_val.parsed),[](const auto& record){ return record.is_valid(); });
+				ret_val.file.reset();
+				ret_val.records=ret_val.parsed.data();
+				ret_val.size=ret_val.parsed.size();
+			}
+		}
+		else
+		{
+			std::ifstream in{path};
+			std::string line;
+			while(std::getline(in,line))
+			{
+				const auto record=parse_labelled_position(line);
+				if(record && record->result!=game_result::unknown)
+					ret_val.parsed.push_back(*record);
+			}
+			ret_val.records=ret_val.parsed.data();
+			ret_val.size=ret_val.parsed.size();
+		}
+
+		ret_val.labelled=std::count_if(ret_val.records,ret_val.records+ret_val.size,[](const auto& record){ return record.result!=game_result::unknown; });
+		return ret_val;
+	}
+
+	//the pawn hash would remember scores computed with other parameters, so everything is simply computed every time
+	struct no_pawn_cache
+	{
+		using entry_t=eval::pawn_hash_table::entry_t;
+
+		template <typename COMPUTE_FUN_T>
+		entry_t lookup(zobrist, COMPUTE_FUN_T compute_fun) noexcept { return compute_fun(); }
+	};
+
+	double sigmoid(double k, double eval) noexcept
+	{
+		return 1.0/(1.0+std::pow(10.0,-k*eval/400.0));
+	}
+
+	double mean_squared_error(const labelled_positions& positions, const eval::evaluation_parameters& parameters, double k, unsigned thread_count)
+	{
+		std::vector<double> sums(thread_count,0.0);
+		std::vector<std::thread> threads;
+
+		const auto chunk_size=(positions.size+thread_count-1)/thread_count;
+		for(unsigned t=0;t<thread_count;++t)
+		{
+			threads.emplace_back([&,t]()
+			{
+				chessboard board;
+				no_pawn_cache pawn_cache;
+
+				const auto begin=std::min(positions.size,t*chunk_size);
+				const auto end=std::min(positions.size,begin+chunk_size);
+				for(auto i=begin;i<end;++i)
+				{
+					const auto& record=positions.records[i];
+					if(record.result==game_result::unknown)
+						continue;
+
+					board.setup(record);
+					const auto eval=eval::default_evaluation<int>(board,parameters,pawn_cache);
+					const auto white_eval=board.side_to_move()==side::white?eval:-eval;
+
+					const auto error=static_cast<int>(record.result)/2.0-sigmoid(k,white_eval);
+					sums[t]+=error*error;
+				}
+			});
+		}
+		for(auto& thread: threads)
+			thread.join();
+
+		double sum=0;
+		for(const auto partial: sums)
+			sum+=partial;
+		return sum/positions.labelled;
+	}
+
+	//the scaling from centipawns to winning chances, for the parameters we start with. the error is convex enough in it to simply narrow it down
+	double fit_k(const labelled_positions& positions, const eval::evaluation_parameters& parameters, unsigned thread_count)
+	{
+		double low=0.1, high=4.0;
+		while(high-low>0.001)
+		{
+			const auto lower_third=low+(high-low)/3, upper_third=high-(high-low)/3;
+			if(mean_squared_error(positions,parameters,lower_third,thread_count)<mean_squared_error(positions,parameters,upper_third,thread_count))
+				high=upper_third;
+			else
+				low=lower_third;
+		}
+		return (low+high)/2;
+	}
+
+	using parameters_t=eval::evaluation_parameters;
+
+	struct factor_pair_desc { const char* name; eval::factor_pair parameters_t::* member; };
+	constexpr factor_pair_desc factor_pairs[]=
+	{
+		{"isolated_pawn_penalty",&parameters_t::isolated_pawn_penalty},
+		{"backwards_pawn_penalty",&parameters_t::backwards_pawn_penalty},
+		{"doubled_pawn_penalty",&parameters_t::doubled_pawn_penalty},
+		{"passed_pawn_bonus",&parameters_t::passed_pawn_bonus},
+		{"connected_pawn_bonus",&parameters_t::connected_pawn_bonus},
+		{"occupied_hole_bonus",&parameters_t::occupied_hole_bonus},
+		{"rook_on_open_file_bonus",&parameters_t::rook_on_open_file_bonus},
+		{"controlled_square_bonus",&parameters_t::controlled_square_bonus},
+		{"hanging_piece_penalty",&parameters_t::hanging_piece_penalty},
+	};
+
+	//table is the name in king_safety.cpp, init_ and get_ that
+	struct material_factors_desc { const char* name; eval::material_factors<int> parameters_t::* member; const char* table; };
+	constexpr material_factors_desc king_safety_factors[]=
+	{
+		{"castling_rights_factor",&parameters_t::castling_rights_factor,"castling_rights_table"},
+		{"kingsquare_attacker_factor",&parameters_t::kingsquare_attacker_factor,"kingsquare_attacker_table"},
+		{"primary_pawnshield_bonus",&parameters_t::primary_pawnshield_bonus,"primary_pawnshield_table"},
+		{"secondary_pawnshield_bonus",&parameters_t::secondary_pawnshield_bonus,"secondary_pawnshield_table"},
+		{"number_of_open_files_in_king_vicinity_penalty",&parameters_t::number_of_open_files_in_king_vicinity_penalty,"open_files_table"},
+	};
+
+	constexpr std::pair<piece_type,const char*> mobile_pieces[]={{piece_type::bishop,"bishop"},{piece_type::knight,"knight"},{piece_type::rook,"rook"},{piece_type::queen,"queen"}};
+	constexpr std::pair<piece_type,const char*> pst_pieces[]={{piece_type::pawn,"pawn"},{piece_type::bishop,"bishop"},{piece_type::knight,"knight"},{piece_type::rook,"rook"},{piece_type::queen,"queen"},{piece_type::king,"king"}};
+
+	unsigned max_mobility(piece_type t) noexcept
+	{
+		switch(t)
+		{
+			case piece_type::knight: return 8;
+			case piece_type::bishop: return 13;
+			case piece_type::rook: return 14;
+			default: return 27;
+		}
+	}
+
+	template <typename FUN_T>
+	void for_each_material_key(FUN_T fun)
+	{
+		for(unsigned bishops=0;bishops<3;++bishops)
+			for(unsigned knights=0;knights<3;++knights)
+				for(unsigned rooks=0;rooks<3;++rooks)
+					for(unsigned queens=0;queens<2;++queens)
+						fun(eval::material_counts_t{bishops,knights,rooks,queens});
+	}
+
+	//one integer to move up or down. the piece square tables are only tuned for white, mirrored is where blacks copy of the value is
+	struct tunable
+	{
+		std::string name;
+		int* value;
+		int* mirrored=nullptr;
+
+		void add(int delta) const noexcept
+		{
+			*value+=delta;
+			if(mirrored)
+				*mirrored+=delta;
+		}
+	};
+
+	std::vector<tunable> list_tunables(parameters_t& parameters)
+	{
+		std::vector<tunable> ret_val;
+
+		for(const auto& desc: factor_pairs)
+		{
+			ret_val.push_back({std::string{desc.name}+".middlegame",&(parameters.*desc.member).middlegame});
+			ret_val.push_back({std::string{desc.name}+".endgame",&(parameters.*desc.member).endgame});
+		}
+
+		const auto add_material_factors=[&](const char* name, eval::material_factors<int>& factors)
+		{
+			for_each_material_key([&](eval::material_counts_t counts)
+			{
+				const auto key=eval::compute_material_factor_key(counts);
+				ret_val.push_back({std::string{name}+"["+std::to_string(counts.n_bishops)+std::to_string(counts.n_knights)+std::to_string(counts.n_rooks)+std::to_string(counts.n_queens)+"]",&factors[key]});
+			});
+		};
+		for(const auto& desc: king_safety_factors)
+			add_material_factors(desc.name,parameters.*desc.member);
+		add_material_factors("phase_factors",parameters.phase_factors);
+
+		for(const auto& [t, name]: mobile_pieces)
+		{
+			for(unsigned i=0;i<=max_mobility(t);++i)
+				ret_val.push_back({std::string{"mobility_eval_tables["}+name+"]["+std::to_string(i)+"]",&parameters.mobility_eval_tables[t][i]});
+		}
+
+		for(auto [table, table_name]: {std::pair{&parameters.middlegame_pst,"middlegame_pst"},std::pair{&parameters.endgame_pst,"endgame_pst"}})
+		{
+			for(const auto& [t, name]: pst_pieces)
+			{
+				for(std::uint8_t id=0;id<64;++id)
+				{
+					const square sq{id};
+					if(t==piece_type::pawn && (sq.rank()==0 || sq.rank()==7))
+						continue;
+
+					const square mirrored_sq{sq.file(),7-sq.rank()};
+					ret_val.push_back({std::string{table_name}+"["+name+"]["+std::to_string(id)+"]",&(*table)[side::white][t][sq],&(*table)[side::black][t][mirrored_sq]});
+				}
+			}
+		}
+
+		return ret_val;
+	}
+
+	void write_evaluation_parameters(std::ostream& out, const parameters_t& parameters)
+	{
+		out<<"#include <philchess/eval/evaluation_parameters.hpp>\n";
+		out<<"#include <philchess/eval/king_safety.hpp>\n";
+		out<<"#include <philchess/eval/phase.hpp>\n";
+		out<<"\n";
+		out<<"using namespace philchess;\n";
+		out<<"\n";
+		out<<"namespace\n";
+		out<<"{\n";
+		out<<"\tauto init_evaluation_parameters() noexcept\n";
+		out<<"\t{\n";
+		out<<"\t\teval::evaluation_parameters ret_val{};\n";
+		out<<"\t\tret_val.mobility_eval_tables=eval::get_mobility_eval_tables();\n";
+		out<<"\n";
+		for(const auto& [right, name]: {std::pair{castling_right::none,"none"},std::pair{castling_right::kingside,"kingside"},std::pair{castling_right::queenside,"queenside"},std::pair{castling_right::both,"both"}})
+			out<<"\t\tret_val.castling_eval[castling_right::"<<name<<"]="<<parameters.castling_eval[right]<<";\n";
+		out<<"\n";
+		for(const auto& desc: factor_pairs)
+			out<<"\t\tret_val."<<desc.name<<"={"<<(parameters.*desc.member).middlegame<<","<<(parameters.*desc.member).endgame<<"};\n";
+		out<<"\n";
+		for(const auto& desc: king_safety_factors)
+			out<<"\t\tret_val."<<desc.name<<"=eval::get_"<<desc.table<<"();\n";
+		out<<"\n";
+		out<<"\t\tret_val.phase_factors=eval::get_phase_factor_table();\n";
+		out<<"\n";
+		out<<"\t\tret_val.middlegame_pst=eval::get_default_piece_square_table();\n";
+		out<<"\t\tret_val.endgame_pst=eval::get_endgame_piece_square_table();\n";
+		out<<"\n";
+		out<<"\t\treturn ret_val;\n";
+		out<<"\t}\n";
+		out<<"}\n";
+		out<<"\n";
+		out<<"const eval::evaluation_parameters& eval::get_default_evaluation_parameters() noexcept\n";
+		out<<"{\n";
+		out<<"\tconst static auto ret_val=init_evaluation_parameters();\n";
+		out<<"\treturn ret_val;\n";
+		out<<"}\n";
+	}
+
+	void write_material_factors_init(std::ostream& out, const std::string& function, const eval::material_factors<int>& factors)
+	{
+		out<<"\tconstexpr auto "<<function<<" noexcept\n";
+		out<<"\t{\n";
+		out<<"\t\teval::material_factors<int> ret_val{};\n";
+		for_each_material_key([&](eval::material_counts_t counts)
+		{
+			out<<"\t\tret_val[eval::compute_material_factor_key({"<<counts.n_bishops<<","<<counts.n_knights<<","<<counts.n_rooks<<","<<counts.n_queens<<"})]="<<factors[eval::compute_material_factor_key(counts)]<<";\n";
+		});
+		out<<"\n";
+		out<<"\t\treturn ret_val;\n";
+		out<<"\t}\n";
+	}
+
+	void write_king_safety(std::ostream& out, const parameters_t& parameters)
+	{
+		out<<"#include <philchess/eval/king_safety.hpp>\n";
+		out<<"\n";
+		out<<"using namespace philchess;\n";
+		out<<"\n";
+		out<<"namespace\n";
+		out<<"{\n";
+		bool first=true;
+		for(const auto& desc: king_safety_factors)
+		{
+			if(!first)
+				out<<"\t\n";
+			first=false;
+			write_material_factors_init(out,std::string{"init_"}+desc.table+"()",parameters.*desc.member);
+		}
+		out<<"}\n";
+		for(const auto& desc: king_safety_factors)
+		{
+			out<<"\n";
+			out<<"const eval::material_factors<int>& eval::get_"<<desc.table<<"() noexcept\n";
+			out<<"{\n";
+			out<<"\tconst static auto tables=init_"<<desc.table<<"();\n";
+			out<<"\treturn tables;\n";
+			out<<"}\n";
+		}
+	}
+
+	void write_phase(std::ostream& out, const parameters_t& parameters)
+	{
+		out<<"#include <philchess/eval/phase.hpp>\n";
+		out<<"\n";
+		out<<"using namespace philchess;\n";
+		out<<"\n";
+		out<<"namespace\n";
+		out<<"{\n";
+		write_material_factors_init(out,"init_phase_factor_table()",parameters.phase_factors);
+		out<<"}\n";
+		out<<"\n";
+		out<<"const eval::material_factors<int>& eval::get_phase_factor_table()\n";
+		out<<"{\n";
+		out<<"\tconst static auto tables=init_phase_factor_table();\n";
+		out<<"\treturn tables;\n";
+		out<<"}\n";
+	}
+
+	void write_mobility(std::ostream& out, const parameters_t& parameters)
+	{
+		out<<"#include <philchess/eval/mobility.hpp>\n";
+		out<<"\n";
+		out<<"using namespace philchess;\n";
+		out<<"\n";
+		out<<"namespace\n";
+		out<<"{\n";
+		out<<"\tconstexpr auto init_mobility_eval_tables() noexcept //wastes ram and precious cache space for none, king and pawn, which are not used\n";
+		out<<"\t{\n";
+		out<<"\t\tpiece_type_map<eval::mobility_eval_table<int>> ret_val{};\n";
+		for(const auto& [t, name]: mobile_pieces)
+		{
+			out<<"\t\tret_val[piece_type::"<<name<<"] = { ";
+			for(const auto value: parameters.mobility_eval_tables[t])
+				out<<value<<", ";
+			out<<"};\n";
+		}
+		out<<"\n";
+		out<<"\t\treturn ret_val;\n";
+		out<<"\t}\n";
+		out<<"}\n";
+		out<<"\n";
+		out<<"const piece_type_map<eval::mobility_eval_table<int>>& philchess::eval::get_mobility_eval_tables() noexcept\n";
+		out<<"{\n";
+		out<<"\tconst static auto ret_val = init_mobility_eval_tables();\n";
+		out<<"\treturn ret_val;\n";
+		out<<"}\n";
+	}
+
+	void write_piece_square_table_init(std::ostream& out, const std::string& function, const eval::piece_square_table<int>& table)
+	{
+		out<<"\tconstexpr auto "<<function<<" noexcept\n";
+		out<<"\t{\n";
+		out<<"\t\teval::piece_square_table<int> ret_val{};\n";
+		for(const auto& [t, name]: pst_pieces)
+		{
+			out<<"\n";
+			for(std::uint8_t id=0;id<64;++id)
+				out<<"\t\tret_val[side::white][piece_type::"<<name<<"][square{"<<static_cast<unsigned>(id)<<"}]="<<table[side::white][t][square{id}]<<";\n";
+		}
+		out<<"\n";
+		out<<"\n";
+		out<<"\t\t//blacks tables are simply reversed...:\n";
+		out<<"\t\tfor(std::uint8_t p=0;p<ret_val[side::black].size();++p)\n";
+		out<<"\t\t{\n";
+		out<<"\t\t\tconst auto piece_id=static_cast<piece_type>(p);\n";
+		out<<"\t\t\tfor(std::uint8_t sq_id=0;sq_id<ret_val[side::black][piece_id].size();++sq_id)\n";
+		out<<"\t\t\t{\n";
+		out<<"\t\t\t\tconst auto sq=square{sq_id};\n";
+		out<<"\t\t\t\tconst auto opponent_sq=square{sq.file(),7-sq.rank()};\n";
+		out<<"\t\t\t\tret_val[side::black][piece_id][sq]=ret_val[side::white][piece_id][opponent_sq];\n";
+		out<<"\t\t\t}\n";
+		out<<"\t\t};\n";
+		out<<"\n";
+		out<<"\t\treturn ret_val;\n";
+		out<<"\t}\n";
+	}
+
+	void write_piece_square_table(std::ostream& out, const parameters_t& parameters)
+	{
+		out<<"#include <philchess/eval/piece_square_table.hpp>\n";
+		out<<"\n";
+		out<<"using namespace philchess;\n";
+		out<<"\n";
+		out<<"namespace\n";
+		out<<"{\n";
+		write_piece_square_table_init(out,"init_end_piece_square_table()",parameters.endgame_pst);
+		out<<"\n";
+		write_piece_square_table_init(out,"init_middle_piece_square_table()",parameters.middlegame_pst);
+		out<<"\n";
+		out<<"} //end anonymous namespace\n";
+		out<<"\n";
+		out<<"\n";
+		out<<"const eval::piece_square_table<int>& eval::get_default_piece_square_table() noexcept\n";
+		out<<"{\n";
+		out<<"\tconst static auto tables=init_middle_piece_square_table();\n";
+		out<<"\treturn tables;\n";
+		out<<"}\n";
+		out<<"\n";
+		out<<"const eval::piece_square_table<int>& eval::get_endgame_piece_square_table() noexcept\n";
+		out<<"{\n";
+		out<<"\tconst static auto tables=init_end_piece_square_table();\n";
+		out<<"\treturn tables;\n";
+		out<<"}\n";
+	}
+
+	bool write_sources(const std::filesystem::path& directory, const parameters_t& parameters)
+	{
+		std::error_code error;
+		std::filesystem::create_directories(directory,error);
+
+		const auto write=[&](const char* filename, auto write_fun)
+		{
+			std::ofstream out{directory/filename};
+			write_fun(out,parameters);
+			return static_cast<bool>(out);
+		};
+
+		return
+			write("evaluation_parameters.cpp",write_evaluation_parameters) &&
+			write("king_safety.cpp",write_king_safety) &&
+			write("mobility.cpp",write_mobility) &&
+			write("phase.cpp",write_phase) &&
+			write("piece_square_table.cpp",write_piece_square_table);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc<2)
+	{
+		std::cout<<"Usage: "<<argv[0]<<" positions_file [iterations=100] [output_directory=.] [threads=all]"<<std::endl;
+		return 1;
+	}
+
+	const unsigned iterations=argc>2?std::stoul(argv[2]):100;
+	const std::filesystem::path output_directory=argc>3?argv[3]:".";
+	const unsigned thread_count=argc>4?std::stoul(argv[4]):std::max(1u,std::thread::hardware_concurrency());
+
+	const auto start_time=std::chrono::steady_clock::now();
+	const auto seconds=[&](){ return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now()-start_time).count(); };
+
+	const auto positions=read_positions(argv[1]);
+	if(positions.labelled==0)
+	{
+		std::cout<<"No labelled positions in "<<argv[1]<<" ;_;"<<std::endl;
+		return 1;
+	}
+	std::cout<<positions.labelled<<" positions, "<<thread_count<<" threads"<<std::endl;
+
+	auto parameters=eval::get_default_evaluation_parameters();
+	parameters.board_sums_piece_square_tables=false;
+
+	const auto k=fit_k(positions,parameters,thread_count);
+	auto best_error=mean_squared_error(positions,parameters,k,thread_count);
+	std::cout<<"K "<<k<<", error "<<best_error<<" ("<<seconds()<<"s)"<<std::endl;
+
+	const auto tunables=list_tunables(parameters);
+	for(unsigned iteration=1;iteration<=iterations;++iteration)
+	{
+		unsigned changed=0;
+		for(const auto& t: tunables)
+		{
+			for(const auto delta: {+1,-1})
+			{
+				t.add(delta);
+				const auto error=mean_squared_error(positions,parameters,k,thread_count);
+				if(error<best_error)
+				{
+					best_error=error;
+					++changed;
+					break;
+				}
+				t.add(-delta);
+			}
+		}
+
+		std::cout<<"iteration "<<iteration<<": error "<<best_error<<", "<<changed<<" of "<<tunables.size()<<" parameters changed ("<<seconds()<<"s)"<<std::endl;
+		if(!write_sources(output_directory,parameters))
+		{
+			std::cout<<"Could not write to "<<output_directory<<" ;_;"<<std::endl;
+			return 1;
+		}
+		if(changed==0)
+			break;
+	}
+
+	if(!write_sources(output_directory,parameters))
+	{
+		std::cout<<"Could not write to "<<output_directory<<" ;_;"<<std::endl;
+		return 1;
+	}
+	std::cout<<"Written to "<<output_directory<<std::endl;
+}